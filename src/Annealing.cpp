@@ -0,0 +1,305 @@
+#include "Annealing.h"
+#include "ReassignmentEvaluator.h"
+#include "Parallel.hpp"
+#include <chrono>
+#include <cmath>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		using Clock = std::chrono::steady_clock;
+
+		double secondsSince(Clock::time_point start)
+		{
+			return std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		/* average shortest operation time, the temperature unit */
+		double temperatureScale(const DisjunctiveGraph& graph)
+		{
+			if (graph.nodeCount() == 0) return 1.0;
+			double sum = 0.0;
+			for (size_t node = 0; node < graph.nodeCount(); ++node) {
+				int shortest = std::numeric_limits<int>::max();
+				for (const OperationTimeStation* ots = graph.alternativesBegin((int)node); ots != graph.alternativesEnd((int)node); ++ots) {
+					shortest = std::min(shortest, ots->time);
+				}
+				sum += shortest;
+			}
+			return std::max(sum / graph.nodeCount(), 1.0);
+		}
+
+		/* One Markov chain: the current graph, its best and the move generator */
+		struct Chain {
+			DisjunctiveGraph graph;
+			DisjunctiveGraph best;
+			bool bestIsCurrent = true;		// best is stale while the current graph is at least as good
+			int bestMakeSpan;
+			Xoshiro256 rng;
+			AnnealingMoves moves;
+			std::vector<int> path;
+			std::vector<std::vector<int>> blocks;
+			std::vector<size_t> longBlocks;
+			ReassignmentEvaluator evaluator;
+			ReassignmentEvaluator::Insertion insertion;
+			size_t accepted = 0;
+			size_t improvements = 0;
+
+			Chain(const JobContainer& instance, const Schedule& initial, const AnnealingMoves& moves, uint64_t seed)
+				: graph(instance, initial), rng(seed), moves(moves)
+			{
+				bestMakeSpan = graph.makeSpan();
+			}
+
+			const DisjunctiveGraph& bestGraph() const { return bestIsCurrent ? graph : best; }
+
+			void adopt(DisjunctiveGraph&& other)
+			{
+				if (bestIsCurrent) best = graph;
+				graph = std::move(other);
+				bestIsCurrent = graph.makeSpan() < bestMakeSpan;
+				if (bestIsCurrent) {
+					bestMakeSpan = graph.makeSpan();
+					++improvements;
+				}
+			}
+
+			/* picks a move on the critical path, false if the draw gave none */
+			bool propose(int& node, StationID& station, size_t& position)
+			{
+				graph.criticalPath(path);
+				graph.criticalBlocks(path, blocks);
+				longBlocks.clear();
+				for (size_t b = 0; b < blocks.size(); ++b) {
+					if (blocks[b].size() >= 2) longBlocks.push_back(b);
+				}
+
+				double total = moves.swap + moves.insert + moves.reassign;
+				double draw = rng.uniformReal() * total;
+				bool blockMove = draw < moves.swap + moves.insert && !longBlocks.empty();
+				if (blockMove) {
+					const std::vector<int>& block = blocks[longBlocks[rng.uniformInt((uint32_t)longBlocks.size())]];
+					size_t first = graph.position(block.front());
+					station = graph.station(block.front());
+					if (draw < moves.swap) {
+						// adjacent critical operations never close a cycle when swapped
+						size_t j = rng.uniformInt((uint32_t)block.size() - 1);
+						node = block[j];
+						position = first + j + 1;
+						return true;
+					}
+					if (rng() >> 63) {
+						node = block.front();
+						size_t j = 1 + rng.uniformInt((uint32_t)block.size() - 1);
+						for (size_t k = 1; k <= j; ++k) {
+							if (!graph.canMoveBehind(node, block[k])) return false;
+						}
+						position = first + j;
+						return true;
+					}
+					node = block.back();
+					size_t j = rng.uniformInt((uint32_t)block.size() - 1);
+					for (size_t k = block.size() - 1; k-- > j;) {
+						if (!graph.canMoveBefore(node, block[k])) return false;
+					}
+					position = first + j;
+					return true;
+				}
+
+				node = path[rng.uniformInt((uint32_t)path.size())];
+				const OperationTimeStation* alternatives = graph.alternativesBegin(node);
+				size_t count = graph.alternativesEnd(node) - alternatives;
+				if (count < 2) return false;
+				const OperationTimeStation& ots = alternatives[rng.uniformInt((uint32_t)count)];
+				if (ots.stationID == graph.station(node)) return false;
+				evaluator.invalidate();
+				if (!evaluator.bestInsertion(graph, node, ots.stationID, ots.time, insertion)) return false;
+				station = ots.stationID;
+				position = insertion.position;
+				return true;
+			}
+
+			/* one Metropolis step at an absolute temperature, true if a move was kept */
+			bool step(double temperature)
+			{
+				int node;
+				StationID station;
+				size_t position;
+				if (graph.nodeCount() == 0 || !propose(node, station, position)) return false;
+
+				int before = graph.makeSpan();
+				StationID oldStation = graph.station(node);
+				size_t oldPosition = graph.position(node);
+				if (!graph.applyMove(node, station, position)) return false;
+
+				int delta = graph.makeSpan() - before;
+				if (delta > 0) {
+					bool keep = temperature > 0.0 && rng.uniformReal() < std::exp(-delta / temperature);
+					if (!keep) {
+						graph.applyMove(node, oldStation, oldPosition);
+						return false;
+					}
+					if (bestIsCurrent) {
+						// leaving the best for a worse graph, take the snapshot now
+						graph.applyMove(node, oldStation, oldPosition);
+						best = graph;
+						bestIsCurrent = false;
+						graph.applyMove(node, station, position);
+					}
+				}
+				++accepted;
+				if (graph.makeSpan() < bestMakeSpan) {
+					bestMakeSpan = graph.makeSpan();
+					bestIsCurrent = true;
+					++improvements;
+				}
+				return true;
+			}
+		};
+	}
+
+	struct SimulatedAnnealing::State {
+		const JobContainer& instance;
+		AnnealingOptions options;
+		Chain chain;
+		double scale;
+		Clock::time_point start;
+		size_t iteration = 0;
+		bool outOfTime = false;
+
+		State(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options)
+			: instance(instance), options(options), chain(instance, initial, options.moves, options.seed), start(Clock::now())
+		{
+			scale = temperatureScale(chain.graph);
+		}
+
+		bool running() const
+		{
+			return !outOfTime && iteration < options.iterations;
+		}
+
+		/* geometric cooling on the further of iteration and time progress */
+		double temperature()
+		{
+			double progress = options.iterations > 0 ? (double)iteration / options.iterations : 1.0;
+			if (options.timeLimit > 0.0) {
+				double elapsed = secondsSince(start);
+				outOfTime = elapsed >= options.timeLimit;
+				progress = std::max(progress, elapsed / options.timeLimit);
+			}
+			progress = std::min(progress, 1.0);
+			return scale * options.startTemperature * std::pow(options.endTemperature / options.startTemperature, progress);
+		}
+	};
+
+	SimulatedAnnealing::SimulatedAnnealing(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options)
+		: m_state(new State(instance, initial, options))
+	{
+	}
+
+	SimulatedAnnealing::~SimulatedAnnealing() = default;
+
+	bool SimulatedAnnealing::run(size_t iterations)
+	{
+		State& state = *m_state;
+		double temperature = state.temperature();
+		for (size_t i = 0; i < iterations && state.running(); ++i) {
+			// the clock and pow only every 64 steps
+			if (i % 64 == 63) temperature = state.temperature();
+			state.chain.step(temperature);
+			++state.iteration;
+		}
+		if (state.options.timeLimit > 0.0) state.temperature();
+		return state.running();
+	}
+
+	int SimulatedAnnealing::bestMakeSpan() const
+	{
+		return m_state->chain.bestMakeSpan;
+	}
+
+	Schedule SimulatedAnnealing::bestSchedule() const
+	{
+		return m_state->chain.bestGraph().toSchedule(m_state->instance);
+	}
+
+	void SimulatedAnnealing::immigrate(const Schedule& schedule)
+	{
+		m_state->chain.adopt(DisjunctiveGraph(m_state->instance, schedule));
+	}
+
+	AnnealingResult SimulatedAnnealing::result() const
+	{
+		AnnealingResult result;
+		result.bestSchedule = bestSchedule();
+		result.bestMakeSpan = m_state->chain.bestMakeSpan;
+		result.iterations = m_state->iteration;
+		result.accepted = m_state->chain.accepted;
+		result.improvements = m_state->chain.improvements;
+		return result;
+	}
+
+	AnnealingResult simulatedAnnealing(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options)
+	{
+		SimulatedAnnealing search(instance, initial, options);
+		search.run(options.iterations);
+		return search.result();
+	}
+
+	TemperingResult parallelTempering(const JobContainer& instance, const Schedule& initial, const TemperingOptions& options)
+	{
+		TemperingResult result;
+		Clock::time_point start = Clock::now();
+		size_t replicaCount = options.replicas != 0 ? options.replicas : Parallel::resolveThreadCount(0);
+		replicaCount = std::max<size_t>(replicaCount, 2);
+
+		std::vector<std::unique_ptr<Chain>> chains;
+		for (size_t r = 0; r < replicaCount; ++r) {
+			chains.emplace_back(new Chain(instance, initial, options.moves, Xoshiro256::stream(options.seed, r)()));
+		}
+		double scale = temperatureScale(chains[0]->graph);
+		std::vector<double> ladder(replicaCount);
+		for (size_t level = 0; level < replicaCount; ++level) {
+			double fraction = (double)level / (replicaCount - 1);
+			ladder[level] = scale * options.minTemperature * std::pow(options.maxTemperature / options.minTemperature, fraction);
+		}
+		// chain sitting at every level, exchanges permute this instead of moving graphs
+		std::vector<size_t> atLevel(replicaCount);
+		for (size_t level = 0; level < replicaCount; ++level) atLevel[level] = level;
+		Xoshiro256 exchangeRng = Xoshiro256::stream(options.seed, replicaCount);
+
+		Parallel::WorkerPool pool((unsigned)std::min<size_t>(Parallel::resolveThreadCount(options.threadCount), replicaCount));
+		size_t interval = std::max<size_t>(options.exchangeInterval, 1);
+		bool outOfTime = false;
+		for (size_t round = 0; result.iterations < options.iterations && !outOfTime; ++round) {
+			size_t steps = std::min(interval, options.iterations - result.iterations);
+			pool.parallelFor(replicaCount, [&](size_t level, unsigned) {
+				Chain& chain = *chains[atLevel[level]];
+				for (size_t i = 0; i < steps; ++i) {
+					if (options.timeLimit > 0.0 && i % 64 == 63 && secondsSince(start) >= options.timeLimit) break;
+					chain.step(ladder[level]);
+				}
+			});
+			result.iterations += steps;
+			outOfTime = options.timeLimit > 0.0 && secondsSince(start) >= options.timeLimit;
+
+			for (size_t level = round % 2; level + 1 < replicaCount; level += 2) {
+				const Chain& cold = *chains[atLevel[level]];
+				const Chain& hot = *chains[atLevel[level + 1]];
+				double exponent = (1.0 / ladder[level] - 1.0 / ladder[level + 1]) * (cold.graph.makeSpan() - hot.graph.makeSpan());
+				++result.exchangeAttempts;
+				if (exponent >= 0.0 || exchangeRng.uniformReal() < std::exp(exponent)) {
+					std::swap(atLevel[level], atLevel[level + 1]);
+					++result.exchanges;
+				}
+			}
+		}
+
+		size_t bestChain = 0;
+		for (size_t r = 1; r < replicaCount; ++r) {
+			if (chains[r]->bestMakeSpan < chains[bestChain]->bestMakeSpan) bestChain = r;
+		}
+		result.bestMakeSpan = chains[bestChain]->bestMakeSpan;
+		result.bestSchedule = chains[bestChain]->bestGraph().toSchedule(instance);
+		return result;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "DisjunctiveGraph.h"
+#include "ImprovementSearch.h"
+#include <memory>
+
+namespace ConstructionAlgorithm {
+	/* Relative weights of the move kinds, all on the critical path of the current schedule:
+	   swap of two adjacent operations of a critical block, insert of a block's first (last) operation
+	   behind (in front of) another operation of the block, and reassign of a critical operation to
+	   another eligible station at its best insertion point */
+	struct AnnealingMoves {
+		double swap = 1.0;
+		double insert = 1.0;
+		double reassign = 1.0;
+	};
+
+	struct AnnealingOptions {
+		/* temperatures are multiples of the average shortest operation time (as in IteratedGreedyOptions),
+		   cooling is geometric from start to end over the iterations or the time limit, whichever runs out first */
+		double startTemperature = 1.0;
+		double endTemperature = 0.01;
+		size_t iterations = 100000;
+		double timeLimit = 0.0;			// seconds from construction, 0 -> none
+		AnnealingMoves moves;
+		uint64_t seed = 1;
+	};
+
+	struct AnnealingResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t iterations = 0;
+		size_t accepted = 0;
+		size_t improvements = 0;
+	};
+
+	/* Simulated annealing on the disjunctive graph of a finished schedule (any ConstructionSolver output).
+	   A move is applied with the graph's incremental update, the makespan delta decides Metropolis
+	   acceptance and a rejected move is applied backwards. The best graph is only copied when the
+	   search is about to leave it for a worse one. */
+	class SimulatedAnnealing : public ImprovementSearch {
+	public:
+		/* the instance is kept by reference and must outlive the search */
+		SimulatedAnnealing(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options = AnnealingOptions());
+		~SimulatedAnnealing() override;
+
+		/* iterations and the time limit count over all runs */
+		bool run(size_t iterations) override;
+		int bestMakeSpan() const override;
+		Schedule bestSchedule() const override;
+		/* the chain continues from the schedule at the current temperature */
+		void immigrate(const Schedule& schedule) override;
+
+		AnnealingResult result() const;
+
+	private:
+		struct State;
+		std::unique_ptr<State> m_state;
+	};
+
+	/* SimulatedAnnealing run until the iterations or the time limit run out */
+	AnnealingResult simulatedAnnealing(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options = AnnealingOptions());
+
+	struct TemperingOptions {
+		size_t replicas = 0;			// 0 -> hardware concurrency, at least 2
+		/* geometric ladder, same unit as AnnealingOptions */
+		double minTemperature = 0.05;
+		double maxTemperature = 2.0;
+		size_t exchangeInterval = 200;	// steps every replica makes between exchange rounds
+		size_t iterations = 100000;		// per replica
+		double timeLimit = 0.0;			// seconds, 0 -> none
+		AnnealingMoves moves;
+		unsigned threadCount = 0;		// 0 -> hardware concurrency
+		uint64_t seed = 1;
+	};
+
+	struct TemperingResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t iterations = 0;			// per replica
+		size_t exchangeAttempts = 0;
+		size_t exchanges = 0;
+	};
+
+	/* Parallel tempering: replicas at fixed temperatures of the ladder run in parallel, between rounds
+	   neighbouring levels swap with probability min(1, exp((1/T_cold - 1/T_hot) * (E_cold - E_hot))),
+	   alternating even and odd pairs. A swap exchanges which replica sits at which temperature, graphs and
+	   schedules never move. Replica r draws from Xoshiro256::stream(seed, r), so without a time limit the
+	   result doesn't depend on the thread count. */
+	TemperingResult parallelTempering(const JobContainer& instance, const Schedule& initial, const TemperingOptions& options = TemperingOptions());
+}
@@ -0,0 +1,172 @@
+#include "Beam.h"
+#include "Parallel.hpp"
+
+namespace ConstructionAlgorithm {
+	int beamEvaluation(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		return std::max(loadLowerBound(jobContainer, schedule), jobLowerBound(jobContainer));
+	}
+
+	namespace {
+		const size_t NoNode = std::numeric_limits<size_t>::max();
+
+		struct BeamNode {
+			size_t parent;
+			size_t depth;
+			ScheduleDecision decision;
+		};
+
+		struct BeamChild {
+			size_t parent;
+			ScheduleDecision decision;
+			int evaluation;
+			float score;
+		};
+
+		struct BeamWorker {
+			JobContainer jobContainer;
+			Schedule schedule = Schedule(0);
+			size_t node = 0;	// the worker's schedule holds this node's path
+			std::vector<ScheduleDecision> path;
+			std::vector<ScoredDecision> candidates;
+		};
+
+		/* unstack to the common ancestor, then replay down to target */
+		void moveTo(BeamWorker& worker, const std::vector<BeamNode>& nodes, size_t target)
+		{
+			worker.path.clear();
+			size_t current = worker.node;
+			while (nodes[current].depth > nodes[target].depth) {
+				worker.schedule.unstackScheduleOperation(worker.jobContainer);
+				current = nodes[current].parent;
+			}
+			while (nodes[target].depth > nodes[current].depth) {
+				worker.path.push_back(nodes[target].decision);
+				target = nodes[target].parent;
+			}
+			while (current != target) {
+				worker.schedule.unstackScheduleOperation(worker.jobContainer);
+				current = nodes[current].parent;
+				worker.path.push_back(nodes[target].decision);
+				target = nodes[target].parent;
+			}
+			for (auto it = worker.path.rbegin(); it != worker.path.rend(); ++it) {
+				worker.schedule.stackScheduleOperation(it->stationID, it->operationID, it->jobID, worker.jobContainer);
+			}
+		}
+	}
+
+	BeamResult beamSearch(const JobContainer& instance, const BeamOptions& options)
+	{
+		BeamResult result;
+		size_t width = std::max<size_t>(options.width, 1);
+		size_t branching = std::max<size_t>(options.branching, 1);
+
+		size_t operationCount = 0;
+		for (const auto& jobIT : instance.getJobs()) operationCount += jobIT.second.getOperaions().size();
+
+		// node pool: root + width states per level, all sized up front
+		std::vector<BeamNode> nodes;
+		nodes.reserve(1 + width * operationCount);
+		nodes.push_back({ NoNode, 0, ScheduleDecision() });
+		std::vector<size_t> beam, nextBeam;
+		beam.reserve(width);
+		nextBeam.reserve(width);
+		beam.push_back(0);
+		std::vector<BeamChild> children(width * branching);
+		std::vector<size_t> order;
+		order.reserve(width * branching);
+
+		PlannerConfig callerSettings = threadSettings();
+		// one pool for all levels, threads are started once per search
+		Parallel::WorkerPool pool((unsigned)std::min<size_t>(Parallel::resolveThreadCount(options.threadCount), width));
+		std::vector<std::unique_ptr<BeamWorker>> workers(pool.workerCount());
+		auto workerAt = [&](unsigned workerIndex) -> BeamWorker& {
+			std::unique_ptr<BeamWorker>& worker = workers[workerIndex];
+			if (!worker) {
+				worker.reset(new BeamWorker());
+				worker->jobContainer = instance;
+				worker->jobContainer.restartContainer();
+				worker->schedule = Schedule(instance.stationCount());
+				worker->path.reserve(operationCount);
+			}
+			return *worker;
+		};
+
+		for (size_t level = 0; level < operationCount; ++level) {
+			for (BeamChild& child : children) child.parent = NoNode;
+
+			pool.parallelFor(beam.size(), [&](size_t index, unsigned workerIndex) {
+				BeamWorker& worker = workerAt(workerIndex);
+				callerSettings.apply();
+				moveTo(worker, nodes, beam[index]);
+				worker.node = beam[index];
+
+				JobContainer& jobContainer = worker.jobContainer;
+				Schedule& schedule = worker.schedule;
+				collectCandidates(jobContainer, schedule, options.candidateScorer, worker.candidates);
+				keepBestCandidates(worker.candidates, branching);
+				for (size_t i = 0; i < worker.candidates.size(); ++i) {
+					const ScoredDecision& candidate = worker.candidates[i];
+					BeamChild& child = children[index * branching + i];
+					schedule.stackScheduleOperation(candidate.decision.stationID, candidate.decision.operationID,
+						candidate.decision.jobID, jobContainer);
+					if (options.completion) {
+						size_t mark = schedule.scheduledCount();
+						while (!jobContainer.isDone()) {
+							ScheduleDecision sd = options.completion(jobContainer, schedule);
+							schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+						}
+						child.evaluation = schedule.makeSpan();
+						schedule.unstackTo(mark - 1, jobContainer);
+					}
+					else {
+						child.evaluation = options.evaluation(jobContainer, schedule);
+						schedule.unstackScheduleOperation(jobContainer);
+					}
+					child.parent = beam[index];
+					child.decision = candidate.decision;
+					child.score = candidate.score;
+				}
+			});
+
+			// best width children; slot order (parent rank, candidate rank) breaks remaining ties
+			order.clear();
+			for (size_t slot = 0; slot < children.size(); ++slot) {
+				if (children[slot].parent != NoNode) order.push_back(slot);
+			}
+			result.evaluatedStates += order.size();
+			size_t keep = std::min(width, order.size());
+			std::partial_sort(order.begin(), order.begin() + keep, order.end(), [&](size_t a, size_t b) {
+				if (children[a].evaluation != children[b].evaluation) return children[a].evaluation < children[b].evaluation;
+				if (children[a].score != children[b].score) return children[a].score < children[b].score;
+				return a < b;
+			});
+			nextBeam.clear();
+			for (size_t i = 0; i < keep; ++i) {
+				const BeamChild& child = children[order[i]];
+				nodes.push_back({ child.parent, level + 1, child.decision });
+				nextBeam.push_back(nodes.size() - 1);
+			}
+			beam.swap(nextBeam);
+		}
+		callerSettings.apply();
+
+		// every state is complete now, a custom evaluation needn't be the makespan so compare them
+		BeamWorker& worker = workerAt(0);
+		size_t best = beam.front();
+		result.makeSpan = std::numeric_limits<int>::max();
+		for (size_t node : beam) {
+			moveTo(worker, nodes, node);
+			worker.node = node;
+			if (worker.schedule.makeSpan() < result.makeSpan) {
+				result.makeSpan = worker.schedule.makeSpan();
+				best = node;
+			}
+		}
+		moveTo(worker, nodes, best);
+		worker.node = best;
+		result.schedule = worker.schedule;
+		return result;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Portfolio.h"
+
+namespace ConstructionAlgorithm {
+	using StateEvaluation = std::function<int(const JobContainer& jobContainer, const Schedule& schedule)>;
+
+	/* max(loadLowerBound, jobLowerBound), the partial makespan is part of the load bound */
+	int beamEvaluation(const JobContainer& jobContainer, const Schedule& schedule);
+
+	struct BeamOptions {
+		size_t width = 8;
+		size_t branching = 4;		// children per state, the best ones by candidateScorer
+		CandidateScorer candidateScorer = EET_Score;
+		/* Children are rated by the makespan this planner completes them to (undone afterwards).
+		   When it is the scorer's own rule the beam never ends worse than that rule run alone.
+		   Left empty, evaluation rates them instead, much cheaper but a lot weaker. */
+		ConstructionSolver::ConstrutionFunction completion = EET_Planner;
+		StateEvaluation evaluation = beamEvaluation;
+		unsigned threadCount = 0;	// 0 -> hardware concurrency
+	};
+
+	struct BeamResult {
+		Schedule schedule = Schedule(0);
+		int makeSpan = 0;
+		size_t evaluatedStates = 0;
+	};
+
+	/* Beam search over partial schedules, one operation per level. Work per level is width * branching
+	   child ratings (ties by candidate score), so run time is linear in width. States are nodes of a
+	   preallocated tree (parent + decision); workers move their own instance copy between states by
+	   unstacking to the common ancestor and replaying, so expansion neither copies nor allocates.
+	   Scorer, completion and evaluation run with the calling thread's planner settings. */
+	BeamResult beamSearch(const JobContainer& instance, const BeamOptions& options = BeamOptions());
+}
@@ -0,0 +1,375 @@
+#include "BranchAndBound.h"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		using Clock = std::chrono::steady_clock;
+
+		struct Subproblem {
+			std::vector<ScheduleDecision> prefix;
+			int bound;
+		};
+
+		struct alignas(64) WorkQueue {
+			std::mutex mutex;
+			std::deque<Subproblem> subproblems;
+		};
+
+		/* Instance data that doesn't change during the search and everything the workers share */
+		struct Search {
+			const JobContainer& instance;
+			const BranchAndBoundOptions& options;
+			Clock::time_point start;
+
+			// [jobID][operationID]: shortest path after the operation, time on its only station (0 when it has more)
+			std::vector<std::vector<int>> tailAfter;
+			std::vector<std::vector<int>> singleTime;
+			// previous identical job, -1 when none
+			std::vector<long> identicalBefore;
+
+			std::atomic<int> incumbent;
+			std::mutex bestMutex;
+			std::vector<ScheduleDecision> bestDecisions;
+
+			std::vector<WorkQueue> queues;
+			std::atomic<size_t> pending{ 0 };
+			std::atomic<unsigned> hungry{ 0 };
+			std::atomic<size_t> nodes{ 0 };
+			std::atomic<size_t> steals{ 0 };
+			std::atomic<bool> stop{ false };
+			std::mutex openMutex;
+			int openBound = std::numeric_limits<int>::max();
+
+			Search(const JobContainer& instance, const BranchAndBoundOptions& options, unsigned workerCount)
+				: instance(instance), options(options), start(Clock::now()), queues(workerCount)
+			{
+				size_t jobSlots = 0;
+				for (const auto& jobIT : instance.getJobs()) jobSlots = std::max<size_t>(jobSlots, jobIT.first + 1);
+				tailAfter.resize(jobSlots);
+				singleTime.resize(jobSlots);
+				identicalBefore.assign(jobSlots, -1);
+				for (const auto& jobIT : instance.getJobs()) {
+					const Job& job = jobIT.second;
+					OperationID lastID = job.getOperaions().empty() ? 0 : job.getOperaions().rbegin()->first;
+					tailAfter[job.jobID].assign(lastID + 1, 0);
+					singleTime[job.jobID].assign(lastID + 1, 0);
+					for (const auto& operationIT : job.getOperaions()) {
+						const Operation& operation = operationIT.second;
+						tailAfter[job.jobID][operation.operationID] = (int)(job.criticalPath(operation.operationID) + 0.5f) - operation.getShortestProcessTime();
+						if (operation.getOperationTimeStations().size() == 1) {
+							singleTime[job.jobID][operation.operationID] = operation.getOperationTimeStations().front().time;
+						}
+					}
+				}
+				if (options.symmetryBreaking) findIdenticalJobs();
+			}
+
+			static bool sameOperation(const Operation& a, const Operation& b)
+			{
+				const std::vector<OperationTimeStation>& x = a.getOperationTimeStations();
+				const std::vector<OperationTimeStation>& y = b.getOperationTimeStations();
+				if (x.size() != y.size() || a.getPredecessors() != b.getPredecessors()) return false;
+				for (size_t i = 0; i < x.size(); ++i) {
+					if (x[i].stationID != y[i].stationID || x[i].time != y[i].time) return false;
+				}
+				return true;
+			}
+
+			static bool sameJob(const Job& a, const Job& b)
+			{
+				if (a.getOperaions().size() != b.getOperaions().size()) return false;
+				for (auto itA = a.getOperaions().begin(), itB = b.getOperaions().begin(); itA != a.getOperaions().end(); ++itA, ++itB) {
+					if (itA->first != itB->first || !sameOperation(itA->second, itB->second)) return false;
+				}
+				return true;
+			}
+
+			void findIdenticalJobs()
+			{
+				// every job links to the last identical one before it, so a class starts in ID order
+				std::vector<const Job*> seen;
+				for (const auto& jobIT : instance.getJobs()) {
+					for (size_t i = seen.size(); i-- > 0;) {
+						if (sameJob(*seen[i], jobIT.second)) {
+							identicalBefore[jobIT.first] = (long)seen[i]->jobID;
+							break;
+						}
+					}
+					seen.push_back(&jobIT.second);
+				}
+			}
+
+			bool stopped() const { return stop.load(std::memory_order_relaxed); }
+
+			void leaveOpen(int bound)
+			{
+				std::lock_guard<std::mutex> lock(openMutex);
+				openBound = std::min(openBound, bound);
+			}
+
+			void offer(int makeSpan, const std::vector<ScheduleDecision>& decisions)
+			{
+				std::lock_guard<std::mutex> lock(bestMutex);
+				if (makeSpan >= incumbent.load()) return;
+				incumbent.store(makeSpan);
+				bestDecisions = decisions;
+			}
+
+			void push(unsigned workerIndex, Subproblem&& subproblem)
+			{
+				pending.fetch_add(1);
+				std::lock_guard<std::mutex> lock(queues[workerIndex].mutex);
+				queues[workerIndex].subproblems.push_back(std::move(subproblem));
+			}
+
+			/* own queue from the back (depth first), the others from the front (largest subtrees) */
+			bool take(unsigned workerIndex, Subproblem& subproblem)
+			{
+				{
+					std::lock_guard<std::mutex> lock(queues[workerIndex].mutex);
+					std::deque<Subproblem>& own = queues[workerIndex].subproblems;
+					if (!own.empty()) {
+						subproblem = std::move(own.back());
+						own.pop_back();
+						return true;
+					}
+				}
+				for (size_t offset = 1; offset < queues.size(); ++offset) {
+					WorkQueue& queue = queues[(workerIndex + offset) % queues.size()];
+					std::lock_guard<std::mutex> lock(queue.mutex);
+					if (queue.subproblems.empty()) continue;
+					subproblem = std::move(queue.subproblems.front());
+					queue.subproblems.pop_front();
+					steals.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+				return false;
+			}
+		};
+
+		struct Child {
+			ScheduleDecision decision;
+			int start;
+			int end;
+			int tail;
+		};
+
+		class Worker {
+		public:
+			Worker(Search& search, unsigned workerIndex)
+				: m_search(search), m_workerIndex(workerIndex), m_jobContainer(search.instance), m_schedule(search.instance.stationCount())
+			{
+				m_stackedCount.assign(search.tailAfter.size(), 0);
+			}
+
+			void run()
+			{
+				Subproblem subproblem;
+				while (true) {
+					if (m_search.take(m_workerIndex, subproblem)) {
+						bool closed = false;
+						if (!m_search.stopped()) {
+							load(subproblem.prefix);
+							closed = explore();
+						}
+						if (!closed) m_search.leaveOpen(subproblem.bound);
+						m_search.pending.fetch_sub(1);
+						continue;
+					}
+					if (m_search.pending.load() == 0) break;
+					m_search.hungry.fetch_add(1);
+					std::this_thread::yield();
+					m_search.hungry.fetch_sub(1);
+				}
+			}
+
+		private:
+			void load(const std::vector<ScheduleDecision>& prefix)
+			{
+				m_jobContainer.restartContainer();
+				m_schedule.clear();
+				m_path.clear();
+				m_pathStart.clear();
+				std::fill(m_stackedCount.begin(), m_stackedCount.end(), 0);
+				m_fixedWork.assign(m_schedule.stationCount(), 0);
+				for (const auto& jobIT : m_jobContainer.getJobs()) {
+					for (const auto& operationIT : jobIT.second.getOperaions()) {
+						int time = m_search.singleTime[jobIT.first][operationIT.first];
+						if (time > 0) m_fixedWork[operationIT.second.getOperationTimeStations().front().stationID] += time;
+					}
+				}
+				for (const ScheduleDecision& sd : prefix) push(sd);
+			}
+
+			void push(const ScheduleDecision& sd)
+			{
+				ScheduledOperation sop = m_schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, m_jobContainer);
+				m_path.push_back(sd);
+				m_pathStart.push_back(sop.startTime);
+				++m_stackedCount[sd.jobID];
+				m_fixedWork[sd.stationID] -= m_search.singleTime[sd.jobID][sd.operationID];
+			}
+
+			void pop()
+			{
+				const ScheduleDecision& sd = m_path.back();
+				m_fixedWork[sd.stationID] += m_search.singleTime[sd.jobID][sd.operationID];
+				--m_stackedCount[sd.jobID];
+				m_schedule.unstackScheduleOperation(m_jobContainer);
+				m_path.pop_back();
+				m_pathStart.pop_back();
+			}
+
+			bool limitReached()
+			{
+				size_t nodes = m_search.nodes.fetch_add(1, std::memory_order_relaxed) + 1;
+				const BranchAndBoundOptions& options = m_search.options;
+				if (options.nodeLimit != 0 && nodes >= options.nodeLimit) return true;
+				if (options.timeLimit > 0.0 && ++m_sinceClock >= 256) {
+					m_sinceClock = 0;
+					return std::chrono::duration<double>(Clock::now() - m_search.start).count() >= options.timeLimit;
+				}
+				return false;
+			}
+
+			/* false when the limit stopped the search before the node was looked at, the caller then
+			   leaves its own bound open; a node stopped after that leaves its bound open itself */
+			bool explore()
+			{
+				if (limitReached()) m_search.stop.store(true);
+				if (m_search.stopped()) return false;
+				if (m_jobContainer.isDone()) {
+					if (m_schedule.makeSpan() < m_search.incumbent.load()) m_search.offer(m_schedule.makeSpan(), m_path);
+					return true;
+				}
+
+				size_t depth = m_path.size();
+				if (m_levels.size() <= depth) m_levels.resize(depth + 1);
+				std::vector<Child>& children = m_levels[depth];
+				children.clear();
+				int lastStart = m_pathStart.empty() ? 0 : m_pathStart.back();
+				StationID lastStation = m_path.empty() ? 0 : m_path.back().stationID;
+
+				// children in canonical order and the node bound in one pass
+				int bound = loadLowerBound(m_jobContainer, m_schedule);
+				int completion = std::numeric_limits<int>::max();
+				for (const auto& jobIT : m_jobContainer.getJobs()) {
+					const Job& job = jobIT.second;
+					long before = m_search.identicalBefore[job.jobID];
+					bool mayStart = m_stackedCount[job.jobID] > 0 || before < 0 || m_stackedCount[before] > 0;
+					for (OperationID operationID : job.getAvailibleOperations()) {
+						const Operation& operation = job.getOperation(operationID);
+						int tail = m_search.tailAfter[job.jobID][operationID];
+						int earliest = std::numeric_limits<int>::max();
+						for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+							int start = m_schedule.fastestTimeForScheduleOperation(ots.stationID, operationID, job.jobID, m_jobContainer);
+							completion = std::min(completion, start + ots.time);
+							earliest = std::min(earliest, std::max(start, lastStart) + ots.time);
+							bool canonical = start > lastStart || (start == lastStart && ots.stationID >= lastStation);
+							if (canonical && mayStart) children.push_back({ { ots.stationID, operationID, job.jobID }, start, start + ots.time, tail });
+						}
+						bound = std::max(bound, earliest + tail);
+					}
+				}
+				for (StationID stationID = 0; stationID < m_fixedWork.size(); ++stationID) {
+					if (m_fixedWork[stationID] == 0) continue;
+					bound = std::max(bound, std::max(m_schedule.getStationAvabilityTime(stationID), lastStart) + m_fixedWork[stationID]);
+				}
+				if (bound >= m_search.incumbent.load(std::memory_order_relaxed)) return true;
+
+				if (m_search.options.activeBranching) {
+					children.erase(std::remove_if(children.begin(), children.end(), [completion](const Child& child) {
+						return child.start >= completion && child.end > completion;
+					}), children.end());
+				}
+				std::sort(children.begin(), children.end(), [](const Child& a, const Child& b) {
+					return a.end != b.end ? a.end < b.end : a.tail > b.tail;
+				});
+
+				size_t count = children.size();
+				for (size_t i = 0; i < count; ++i) {
+					// children is m_levels[depth], copy before the recursion may grow m_levels
+					Child child = m_levels[depth][i];
+					if (std::max(bound, child.end + child.tail) >= m_search.incumbent.load(std::memory_order_relaxed)) continue;
+					if (i + 1 < count && m_search.hungry.load(std::memory_order_relaxed) > 0) {
+						donate(depth, i + 1, count, bound);
+						count = i + 1;
+					}
+					push(child.decision);
+					explore();
+					pop();
+					if (m_search.stopped()) {
+						m_search.leaveOpen(bound);
+						return true;
+					}
+				}
+				return true;
+			}
+
+			void donate(size_t depth, size_t from, size_t to, int bound)
+			{
+				for (size_t i = from; i < to; ++i) {
+					const Child& child = m_levels[depth][i];
+					Subproblem subproblem{ m_path, std::max(bound, child.end + child.tail) };
+					subproblem.prefix.push_back(child.decision);
+					m_search.push(m_workerIndex, std::move(subproblem));
+				}
+			}
+
+			Search& m_search;
+			unsigned m_workerIndex;
+			JobContainer m_jobContainer;
+			Schedule m_schedule;
+			std::vector<ScheduleDecision> m_path;
+			std::vector<int> m_pathStart;
+			std::vector<int> m_stackedCount;
+			std::vector<int> m_fixedWork;
+			std::vector<std::vector<Child>> m_levels;
+			size_t m_sinceClock = 0;
+		};
+	}
+
+	BranchAndBoundResult branchAndBound(const JobContainer& instance, const BranchAndBoundOptions& options)
+	{
+		BranchAndBoundResult result;
+		unsigned workerCount = Parallel::resolveThreadCount(options.threadCount);
+		Search search(instance, options, workerCount);
+
+		JobContainer jobContainer = instance;
+		jobContainer.restartContainer();
+		Schedule schedule(instance.stationCount());
+		ConstructionSolver solver(jobContainer, schedule, CP_HF_Planner);
+		solver.scheduleAll();
+		result.initialMakeSpan = schedule.makeSpan();
+		search.incumbent.store(result.initialMakeSpan);
+		stackedDecisions(schedule, search.bestDecisions);
+
+		search.push(0, Subproblem{ {}, 0 });
+		std::vector<std::unique_ptr<Worker>> workers(workerCount);
+		for (unsigned workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+			workers[workerIndex].reset(new Worker(search, workerIndex));
+		}
+		Parallel::parallelFor(workerCount, workerCount, [&](size_t workerIndex, unsigned) {
+			workers[workerIndex]->run();
+		});
+
+		result.bestMakeSpan = search.incumbent.load();
+		result.nodes = search.nodes.load();
+		result.steals = search.steals.load();
+		result.optimal = !search.stopped();
+		result.lowerBound = result.optimal ? result.bestMakeSpan : std::min(search.openBound, result.bestMakeSpan);
+		result.gap = result.bestMakeSpan > 0 ? (double)(result.bestMakeSpan - result.lowerBound) / result.bestMakeSpan : 0.0;
+
+		jobContainer.restartContainer();
+		schedule.clear();
+		for (const ScheduleDecision& sd : search.bestDecisions) {
+			schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+		}
+		result.bestSchedule = schedule;
+		return result;
+	}
+}
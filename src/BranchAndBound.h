@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Portfolio.h"
+
+namespace ConstructionAlgorithm {
+	struct BranchAndBoundOptions {
+		size_t nodeLimit = 0;			// 0 -> none
+		double timeLimit = 0.0;			// seconds, 0 -> none
+		unsigned threadCount = 1;		// more than 1 splits subtrees with work stealing, 0 -> hardware concurrency
+		bool activeBranching = true;	// Giffler-Thompson conflict set
+		bool symmetryBreaking = true;	// identical jobs start in ID order
+	};
+
+	struct BranchAndBoundResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		int initialMakeSpan = 0;		// CP_HF incumbent
+		int lowerBound = 0;
+		double gap = 0.0;				// (bestMakeSpan - lowerBound) / bestMakeSpan
+		bool optimal = false;			// the tree was closed, bestMakeSpan is the optimum
+		size_t nodes = 0;
+		size_t steals = 0;
+	};
+
+	/* Depth-first branch-and-bound over stacking decisions, made and taken back with the undo trail.
+	   The incumbent starts from CP_HF with the calling thread's settings. Every schedule is enumerated
+	   once, in start time order (ties by station), so a child may not start before the last decision.
+	   With activeBranching only pairs starting before the earliest completion C* of all availible pairs
+	   are children: some optimum (the one with the least sum of completion times) is active in that sense
+	   at every step. With symmetryBreaking a job whose operations, alternatives and precedence equal
+	   those of a job with a lower ID can't start before it. A node is cut when its bound reaches the
+	   incumbent; the bound is the largest of loadLowerBound, per operation earliest completion plus the
+	   shortest path after it and the work left on every station for operations with only that station.
+	   Workers take subtrees from their own deque and steal from the front of the others'; a busy worker
+	   that sees an idle one hands it the rest of its current children. On a node or time limit the lower
+	   bound is the smallest bound of the nodes left open. */
+	BranchAndBoundResult branchAndBound(const JobContainer& instance, const BranchAndBoundOptions& options = BranchAndBoundOptions());
+}
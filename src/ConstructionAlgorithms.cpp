@@ -1,10 +1,14 @@
 #include "ConstructionAlgorithms.h"
+#include "SlackEngine.h"
 
 namespace ConstructionAlgorithm {
 	ConstructionSolver::ConstructionSolver(JobContainer& _jobContainer, Schedule& _schedule, ConstrutionFunction _constructionFunc)
 		:jobContainer(_jobContainer), schedule(_schedule), constructionFunc(_constructionFunc)
 	{
 		jobContainer.restartContainer();
+		incumbent = std::numeric_limits<int>::max();
+		status = SolveStatus::Running;
+		resetBound();
 	}
 
 	JobContainer& ConstructionSolver::getJobContainer()
@@ -26,26 +30,231 @@ namespace ConstructionAlgorithm {
 	{
 		for (int i = 0; i < stepCount; ++i) {
 			if (jobContainer.isDone()) return;
-			ScheduleDecision sd = constructionFunc(jobContainer, schedule);
-			schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+			commitDecision(constructionFunc(jobContainer, schedule));
 		}
 	}
 
-	void ConstructionSolver::scheduleAll()
+	SolveStatus ConstructionSolver::scheduleAll()
 	{
-		while (!jobContainer.isDone()) {
-			ScheduleDecision sd = constructionFunc(jobContainer, schedule);
-			schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+		while (next()) {}
+		return status;
+	}
+
+	std::optional<ScheduleStep> ConstructionSolver::next()
+	{
+		if (jobContainer.isDone()) {
+			status = SolveStatus::Completed;
+			return std::nullopt;
+		}
+		if (cancellationToken && cancellationToken->isCancelled()) {
+			status = SolveStatus::Cancelled;
+			return std::nullopt;
+		}
+		if (incumbent != std::numeric_limits<int>::max() && lowerBound() >= incumbent) {
+			status = SolveStatus::Dominated;
+			return std::nullopt;
+		}
+		status = SolveStatus::Running;
+		ScheduleStep step;
+		step.decision = constructionFunc(jobContainer, schedule);
+		step.scheduledOperation = commitDecision(step.decision);
+		// the last commit finishes the solve, not the next pull
+		if (jobContainer.isDone()) status = SolveStatus::Completed;
+		return step;
+	}
+
+	bool ConstructionSolver::resume(int maxSteps, const std::function<void(const ScheduleStep&)>& onStep)
+	{
+		for (int i = 0; i < maxSteps; ++i) {
+			std::optional<ScheduleStep> step = next();
+			if (!step) return false;
+			if (onStep) onStep(*step);
+		}
+		return !jobContainer.isDone();
+	}
+
+	void ConstructionSolver::setCancellationToken(const CancellationToken& token)
+	{
+		cancellationToken = token;
+	}
+
+	void runInterleaved(const std::vector<ConstructionSolver*>& solvers, int stepsPerTurn,
+		const std::function<void(size_t solverIndex, const ScheduleStep&)>& onStep)
+	{
+		// a turn without a step would never finish any solver
+		stepsPerTurn = std::max(stepsPerTurn, 1);
+		std::vector<bool> active(solvers.size(), true);
+		size_t activeCount = solvers.size();
+		while (activeCount > 0) {
+			for (size_t i = 0; i < solvers.size(); ++i) {
+				if (!active[i]) continue;
+				bool more = solvers[i]->resume(stepsPerTurn, [&](const ScheduleStep& step) {
+					if (onStep) onStep(i, step);
+				});
+				if (!more) {
+					active[i] = false;
+					--activeCount;
+				}
+			}
+		}
+	}
+
+	void ConstructionSolver::setIncumbent(int makeSpan)
+	{
+		incumbent = makeSpan;
+	}
+
+	int ConstructionSolver::lowerBound()
+	{
+		if (boundStale()) resetBound();
+		return std::max(jobBound, loadLowerBound(jobContainer, schedule));
+	}
+
+	int loadLowerBound(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		// stations only grow at their tails, so all remaining work lands after current availability
+		int stationTimeSum = 0;
+		int makeSpan = 0;
+		for (StationID stationID = 0; stationID < (StationID)schedule.stationCount(); ++stationID) {
+			int availability = schedule.getStationAvabilityTime(stationID);
+			stationTimeSum += availability;
+			makeSpan = std::max(makeSpan, availability);
+		}
+		int stationCount = std::max(schedule.stationCount(), 1);
+		int loadBound = (stationTimeSum + jobContainer.remainingShortestWork() + stationCount - 1) / stationCount;
+		return std::max(makeSpan, loadBound);
+	}
+
+	int jobLowerBound(const JobContainer& jobContainer)
+	{
+		int bound = 0;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			const Job& job = jobIT.second;
+			for (OperationID operationID : job.getAvailibleOperations()) {
+				int ready = job.getOperation(operationID).getLastPrecedessorTime();
+				bound = std::max(bound, ready + (int)job.criticalPath(operationID));
+			}
 		}
+		return bound;
 	}
 
-	int dispatch_operation_mode = 0;
-	int dispatch_station_mode = 0;
-	std::vector<double> params;
+	int stackedJobBound(const JobContainer& jobContainer, const ScheduledOperation& sop)
+	{
+		const Job& job = jobContainer.getJob(sop.jobID);
+		float tail = 0;
+		for (OperationID successorID : job.getSuccessors(sop.operationID)) {
+			tail = std::max(tail, job.criticalPath(successorID));
+		}
+		return sop.endTime() + (int)tail;
+	}
+
+	void stackedDecisions(const Schedule& schedule, std::vector<ScheduleDecision>& decisions)
+	{
+		decisions.clear();
+		const std::vector<std::vector<ScheduledOperation>>& stations = schedule.getSchedule();
+		const std::vector<StationID>& stackOrder = schedule.getStackOrder();
+		size_t total = 0;
+		for (const std::vector<ScheduledOperation>& station : stations) total += station.size();
+
+		if (stackOrder.size() == total) {
+			std::vector<size_t> cursor(stations.size(), 0);
+			for (StationID stationID : stackOrder) {
+				const ScheduledOperation& sop = stations[stationID][cursor[stationID]++];
+				decisions.push_back({ stationID, sop.operationID, sop.jobID });
+			}
+			return;
+		}
+		// tail appends only, so start time order respects both precedence and station order
+		std::vector<const ScheduledOperation*> operations;
+		for (const std::vector<ScheduledOperation>& station : stations) {
+			for (const ScheduledOperation& sop : station) operations.push_back(&sop);
+		}
+		std::stable_sort(operations.begin(), operations.end(), [](const ScheduledOperation* a, const ScheduledOperation* b) {
+			return a->startTime < b->startTime;
+		});
+		for (const ScheduledOperation* sop : operations) decisions.push_back({ sop->stationID, sop->operationID, sop->jobID });
+	}
+
+	SolveStatus ConstructionSolver::getStatus() const
+	{
+		return status;
+	}
+
+	ScheduledOperation ConstructionSolver::commitDecision(const ScheduleDecision& sd)
+	{
+		if (boundStale()) resetBound();
+		ScheduledOperation sop = schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+		jobBound = std::max(jobBound, stackedJobBound(jobContainer, sop));
+		boundDepth = schedule.scheduledCount();
+		return sop;
+	}
+
+	bool ConstructionSolver::boundStale() const
+	{
+		// a restart or an unstack removed operations the running max still counts
+		return boundStamp != jobContainer.restartStamp() || schedule.scheduledCount() < boundDepth;
+	}
+
+	void ConstructionSolver::resetBound()
+	{
+		boundStamp = jobContainer.restartStamp();
+		boundDepth = schedule.scheduledCount();
+		jobBound = jobLowerBound(jobContainer);
+	}
+
+	thread_local int dispatch_operation_mode = 0;
+	thread_local int dispatch_station_mode = 0;
+	thread_local std::vector<double> params;
 
 	// ------------------------------ Planning algorithms
 
-	ScheduleDecision RNG_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	namespace {
+		/* HF2 with the makespan of the partial schedule passed in, the planner computes it once per decision */
+		float hf2Score(const JobContainer& jobContainer, const Schedule& schedule, int makeSpan, const Job& job, const Operation& operation,
+			const OperationTimeStation& ots)
+		{
+			int endTime = schedule.fastestEndTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+			int envelope = endTime - makeSpan;
+			int alternativeStationCount = operation.getOperationTimeStations().size();
+			int successorCount = job.getSuccessors(operation.operationID).size();
+			float V = envelope + params[0] * alternativeStationCount +
+				params[1] * job.remainingNumOfOperations() + params[2] * successorCount;
+			return V;
+		}
+
+		/* (operation, station) pair with the lowest score, first one in scan order on ties */
+		template <typename Scorer>
+		ScheduleDecision lowestScoreDecision(const JobContainer& jobContainer, const Schedule& schedule, Scorer scorer)
+		{
+			ScheduleDecision sd;
+			float lowestScore = std::numeric_limits<float>::max();
+			for (const auto& jobIT : jobContainer.getJobs()) {
+				const fjss::Job& job = jobIT.second;
+				for (OperationID operationID : job.getAvailibleOperations()) {
+					const fjss::Operation& operation = job.getOperation(operationID);
+					for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+						float score = scorer(jobContainer, schedule, job, operation, ots);
+						if (score < lowestScore) {
+							lowestScore = score;
+							sd.jobID = job.jobID;
+							sd.operationID = operationID;
+							sd.stationID = ots.stationID;
+						}
+					}
+				}
+			}
+			return sd;
+		}
+	}
+
+	ConstructionSolver::ConstrutionFunction make_RNG_Planner(uint64_t seed)
+	{
+		return [rng = Xoshiro256(seed)](const JobContainer& jobContainer, const Schedule&) mutable {
+			return randomDecision(jobContainer, rng);
+		};
+	}
+
+	ScheduleDecision randomDecision(const JobContainer& jobContainer, Xoshiro256& rng)
 	{
 		ScheduleDecision sd;
 		// all currently availible operation from all jobs
@@ -56,7 +265,7 @@ namespace ConstructionAlgorithm {
 			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
 		}
 		// pick random operation form availible
-		std::pair<OperationID, JobID> opIDJobID = avbOps[rand() % avbOps.size()];
+		std::pair<OperationID, JobID> opIDJobID = avbOps[rng.uniformInt(avbOps.size())];
 		const Job& job = jobContainer.getJob(opIDJobID.second);
 		const Operation& operation = job.getOperation(opIDJobID.first);
 		std::vector<OperationTimeStation> ots;
@@ -64,7 +273,7 @@ namespace ConstructionAlgorithm {
 			ots.push_back(it);
 		}
 		// pick random station to insert
-		sd.stationID = ots[rand() % ots.size()].stationID;
+		sd.stationID = ots[rng.uniformInt(ots.size())].stationID;
 		sd.operationID = opIDJobID.first;
 		sd.jobID = opIDJobID.second;
 		return sd;
@@ -462,58 +671,11 @@ namespace ConstructionAlgorithm {
 
 	ScheduleDecision HF2_Planner(const JobContainer& jobContainer, const Schedule& schedule)
 	{
-		ScheduleDecision sd;
-		// all currently availible operation from all jobs
-		std::vector<std::pair<OperationID, JobID>> avbOps;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::vector<OperationID>& jobAvbOps = job.getAvailibleOperations();
-			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
-		}
-		// find operation + station that minimize v function
-		int currentMakeSpan = schedule.makeSpan();
-		float minV = std::numeric_limits<float>::max();
-		for (auto& operationJobID : avbOps) {
-			const fjss::Job& job = jobContainer.getJob(operationJobID.second);
-			const fjss::Operation& operation = job.getOperation(operationJobID.first);
-
-			float thisJobRemainingTime = job.remainingAverageProcessTime();
-			int alternativeStationCount = operation.getOperationTimeStations().size();
-			int successorCount = job.getSuccessors(operation.operationID).size();
-
-			for (auto& operationStationTime : operation.getOperationTimeStations()) {
-				int endTime = schedule.fastestEndTimeForScheduleOperation(
-					operationStationTime.stationID,
-					operationJobID.first,
-					operationJobID.second,
-					jobContainer);
-				int startTime = endTime - operationStationTime.time;
-				int stationWaste = endTime - schedule.getStationAvabilityTime(operationStationTime.stationID)
-					- operationStationTime.time;
-				int envelope = endTime - currentMakeSpan;
-
-				// osttatnie paramertey z 27.05
-				//float V = 6.27 * startTime + 2.08 * envelope + alternativeStationCount * 64.3 - thisJobRemainingTime - successorCount * 43.5;
-
-				// ostatnia sktruktura z 27.05 godz 11:31
-				//float V = startTime + params[0] * envelope + params[1] * alternativeStationCount +
-				//	params[2] * thisJobRemainingTime + params[3] * successorCount;
-
-				// zmiana 03.06.25
-				//float V = envelope + params[0] * alternativeStationCount +
-				//	params[1] * thisJobRemainingTime + params[2] * successorCount;
-				float V = envelope + params[0] * alternativeStationCount +
-					params[1] * job.remainingNumOfOperations() + params[2] * successorCount;
-
-				if (V < minV) {
-					minV = V;
-					sd.jobID = job.jobID;
-					sd.operationID = operation.operationID;
-					sd.stationID = operationStationTime.stationID;
-				}
-			}
-		}
-		return sd;
+		int makeSpan = schedule.makeSpan();
+		return lowestScoreDecision(jobContainer, schedule, [makeSpan](const JobContainer& jobContainer, const Schedule& schedule,
+			const Job& job, const Operation& operation, const OperationTimeStation& ots) {
+			return hf2Score(jobContainer, schedule, makeSpan, job, operation, ots);
+		});
 	}
 
 	ScheduleDecision LPT_EET_Planner(const JobContainer& jobContainer, const Schedule& schedule)
@@ -561,19 +723,8 @@ namespace ConstructionAlgorithm {
 	ScheduleDecision MD_Planner(const JobContainer& jobContainer, const Schedule& schedule)
 	{
 		ScheduleDecision sd;
-		// build station demand map
-		std::map<StationID, int> stationDemandMap;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::map<OperationID, Operation>& jobOperationsMap = job.getOperaions();
-			for (const auto& operationIT : jobOperationsMap) {
-				if (!operationIT.second.isDone()) {
-					for (auto& ots : operationIT.second.getOperationTimeStations()) {
-						stationDemandMap[ots.stationID]++;
-					}
-				}
-			}
-		}
+		// station demand among not done ops is tracked by the container
+		const std::vector<int>& stationDemand = jobContainer.getStationDemands();
 		// all currently availible operation from all jobs
 		std::vector<std::pair<OperationID, JobID>> avbOps;
 		for (const auto& jobIT : jobContainer.getJobs()) {
@@ -594,7 +745,7 @@ namespace ConstructionAlgorithm {
 					operationJobID.first,
 					operationJobID.second,
 					jobContainer);
-				endTime += stationDemandMap[operationStationTime.stationID];
+				endTime += stationDemand[operationStationTime.stationID];
 
 				if (endTime < earliestEndTime) {
 					earliestEndTime = endTime;
@@ -649,76 +800,7 @@ namespace ConstructionAlgorithm {
 
 	ScheduleDecision TBOP_HF_Planner(const JobContainer& jobContainer, const Schedule& schedule)
 	{
-		ScheduleDecision sd;
-		float tm = 0;
-		// build station demand map
-		std::map<StationID, int> stationDemandMap;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::map<OperationID, Operation>& jobOperationsMap = job.getOperaions();
-			for (const auto& operationIT : jobOperationsMap) {
-				if (!operationIT.second.isDone()) {
-					for (auto& ots : operationIT.second.getOperationTimeStations()) {
-						stationDemandMap[ots.stationID]++;
-					}
-					++tm;
-				}
-			}
-		}
-		// all currently availible operation from all jobs
-		std::vector<std::pair<OperationID, JobID>> avbOps;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::vector<OperationID>& jobAvbOps = job.getAvailibleOperations();
-			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
-		}
-
-		// find which operation is shortest
-		float earliestEndTime = std::numeric_limits<int>::max();
-		for (auto& operationJobID : avbOps) {
-			const fjss::Job& job = jobContainer.getJob(operationJobID.second);
-			const fjss::Operation& operation = job.getOperation(operationJobID.first);
-			float timeBlockedByOperation = job.avgTimeBlockedByOperation(operation.operationID);
-
-			for (auto& operationStationTime : operation.getOperationTimeStations()) {
-
-				// Ostatnie parametry z 27.05
-				/*
-				float endTime = schedule.fastestTimeForScheduleOperation(
-					operationStationTime.stationID,
-					operationJobID.first,
-					operationJobID.second,
-					jobContainer) * 10.0;
-				//int stationWaste = endTime - schedule.getStationAvabilityTime(operationStationTime.stationID);
-				endTime -= 0.2*timeBlockedByOperation;
-				endTime = 1.0*(operationStationTime.time - operation.getShortestProcessTime())
-					+ endTime + 50*stationDemandMap[operationStationTime.stationID];
-				*/
-
-				float endTime = schedule.fastestTimeForScheduleOperation(
-					operationStationTime.stationID,
-					operationJobID.first,
-					operationJobID.second,
-					jobContainer);
-				
-				// z dnia 03.06
-				//endTime = endTime + params[0] * timeBlockedByOperation +
-					//params[1] * (operationStationTime.time - operation.getShortestProcessTime()) +
-					//params[2] * stationDemandMap[operationStationTime.stationID];
-
-				endTime = endTime + params[0] * timeBlockedByOperation +
-					params[1] * (operationStationTime.time - operation.getShortestProcessTime()) +
-					params[2] * ((float)stationDemandMap[operationStationTime.stationID] / tm) * operationStationTime.time;
-
-				if (endTime < earliestEndTime) {
-					earliestEndTime = endTime;
-					sd.jobID = job.jobID;
-					sd.operationID = operation.operationID;
-					sd.stationID = operationStationTime.stationID;
-				}
-			}
-		}
-		return sd;
+		return lowestScoreDecision(jobContainer, schedule, TBOP_HF_Score);
 	}
 
 	ScheduleDecision TBOP_Planner(const JobContainer& jobContainer, const Schedule& schedule) {
@@ -838,118 +920,105 @@ namespace ConstructionAlgorithm {
 
 	ScheduleDecision CP_Planner(const JobContainer& jobContainer, const Schedule& schedule)
 	{
-		ScheduleDecision sd;
-		// all currently availible operation from all jobs
-		std::vector<std::pair<OperationID, JobID>> avbOps;
+		return lowestScoreDecision(jobContainer, schedule, CP_Score);
+	}
+
+	ScheduleDecision CP_HF_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		return lowestScoreDecision(jobContainer, schedule, CP_HF_Score);
+	}
+
+	// ------------------------------ Candidate scores
+
+	void collectCandidates(const JobContainer& jobContainer, const Schedule& schedule, const CandidateScorer& scorer,
+		std::vector<ScoredDecision>& candidates)
+	{
+		candidates.clear();
 		for (const auto& jobIT : jobContainer.getJobs()) {
 			const fjss::Job& job = jobIT.second;
-			const std::vector<OperationID>& jobAvbOps = job.getAvailibleOperations();
-			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
+			for (OperationID operationID : job.getAvailibleOperations()) {
+				const fjss::Operation& operation = job.getOperation(operationID);
+				for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+					ScoredDecision candidate;
+					candidate.decision.jobID = job.jobID;
+					candidate.decision.operationID = operationID;
+					candidate.decision.stationID = ots.stationID;
+					candidate.score = scorer(jobContainer, schedule, job, operation, ots);
+					candidates.push_back(candidate);
+				}
+			}
 		}
+	}
 
-		// find which operation is shortest
-		float earliestEndTime = std::numeric_limits<int>::max();
+	void keepBestCandidates(std::vector<ScoredDecision>& candidates, size_t count)
+	{
+		std::stable_sort(candidates.begin(), candidates.end(), [](const ScoredDecision& a, const ScoredDecision& b) {
+			return a.score < b.score;
+		});
+		if (candidates.size() > count) candidates.resize(count);
+	}
 
-		for (auto& operationJobID : avbOps) {
-			const fjss::Job& job = jobContainer.getJob(operationJobID.second);
-			const fjss::Operation& operation = job.getOperation(operationJobID.first);
-			float cpl = job.criticalPath(operation.operationID);
-			int altMach = operation.getOperationTimeStations().size();
+	// HF2, TBOP_HF, CP and CP_HF planners pick the lowest of these
 
-			for (auto& operationStationTime : operation.getOperationTimeStations()) {
-				float endTime = schedule.fastestEndTimeForScheduleOperation(
-					operationStationTime.stationID,
-					operationJobID.first,
-					operationJobID.second,
-					jobContainer);
-				// OSTTANIE PARAMETRY z 27.05
-				//endTime = endTime - cpl;
+	float EIT_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
+	{
+		return schedule.fastestTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+	}
 
-				endTime = endTime - params[0] * cpl;
+	float EET_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
+	{
+		return schedule.fastestEndTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+	}
 
-				if (endTime < earliestEndTime) {
-					earliestEndTime = endTime;
-					sd.jobID = job.jobID;
-					sd.operationID = operation.operationID;
-					sd.stationID = operationStationTime.stationID;
-				}
-			}
-		}
-		return sd;
+	float HF2_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
+	{
+		return hf2Score(jobContainer, schedule, schedule.makeSpan(), job, operation, ots);
 	}
 
-	ScheduleDecision CP_HF_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	float TBOP_HF_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
 	{
-		ScheduleDecision sd;
-		float tm = 0;
-		// build station demand map
-		std::map<StationID, int> stationDemandMap;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::map<OperationID, Operation>& jobOperationsMap = job.getOperaions();
-			for (const auto& operationIT : jobOperationsMap) {
-				if (!operationIT.second.isDone()) {
-					for (auto& ots : operationIT.second.getOperationTimeStations()) {
-						stationDemandMap[ots.stationID]++;
-					}
-					++tm;
-				}
-			}
-		}
-		// all currently availible operation from all jobs
-		std::vector<std::pair<OperationID, JobID>> avbOps;
-		for (const auto& jobIT : jobContainer.getJobs()) {
-			const fjss::Job& job = jobIT.second;
-			const std::vector<OperationID>& jobAvbOps = job.getAvailibleOperations();
-			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
-		}
+		float tm = jobContainer.remainingOperationCount();
+		float timeBlockedByOperation = job.avgTimeBlockedByOperation(operation.operationID);
+		float endTime = schedule.fastestTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+		endTime = endTime + params[0] * timeBlockedByOperation +
+			params[1] * (ots.time - operation.getShortestProcessTime()) +
+			params[2] * ((float)jobContainer.getStationDemand(ots.stationID) / tm) * ots.time;
+		return endTime;
+	}
 
-		// find which operation is shortest
-		float makeSpan = schedule.makeSpan();
-		float earliestEndTime = std::numeric_limits<int>::max();
-		for (auto& operationJobID : avbOps) {
-			const fjss::Job& job = jobContainer.getJob(operationJobID.second);
-			const fjss::Operation& operation = job.getOperation(operationJobID.first);
-			float cpl = job.criticalPath(operation.operationID);
+	float CP_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
+	{
+		float cpl = job.criticalPath(operation.operationID);
+		float endTime = schedule.fastestEndTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+		endTime = endTime - params[0] * cpl;
+		return endTime;
+	}
 
-			for (auto& operationStationTime : operation.getOperationTimeStations()) {
-				float endTime = schedule.fastestTimeForScheduleOperation(
-					operationStationTime.stationID,
-					operationJobID.first,
-					operationJobID.second,
-					jobContainer);
+	float CP_HF_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots)
+	{
+		float tm = jobContainer.remainingOperationCount();
+		float cpl = job.criticalPath(operation.operationID);
+		float endTime = schedule.fastestTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
+		endTime = endTime + params[0] * cpl + params[1] * (ots.time - operation.getShortestProcessTime()) +
+			params[2] * ((float)jobContainer.getStationDemand(ots.stationID) / tm) * ots.time;
+		return endTime;
+	}
 
-				// manual
-				//endTime = 10 * endTime - 0.2 * cpl
-				//	+ 1 * (operationStationTime.time - operation.getShortestProcessTime())
-				//	+ 50 * stationDemandMap[operationStationTime.stationID];  // 1169 insert time nie end
-				// auto
-				// 5.35223 - 0.430275    3.2423   59.5938
-				
-				// ostatnie parametry poniej z 27.05
-				//endTime = 5.35223 * endTime - 0.430275 * cpl
-				//	+ 3.2423 * (operationStationTime.time - operation.getShortestProcessTime())
-				//	+ 59.5938 * stationDemandMap[operationStationTime.stationID];  // 1141 insert time nie end
-
-				// wersja do 03.06
-				//endTime = endTime + params[0] * cpl + params[1] * (operationStationTime.time - operation.getShortestProcessTime()) +
-				//	params[2] * stationDemandMap[operationStationTime.stationID];
-
-				endTime = endTime + params[0] * cpl + params[1] * (operationStationTime.time - operation.getShortestProcessTime()) +
-					params[2] * ((float)stationDemandMap[operationStationTime.stationID] / tm) * operationStationTime.time;
+	ScheduleDecision ELFT_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		// no engine outlives the call, ES / LF are built from scratch
+		SlackEngine slackEngine;
+		return elftDecision(jobContainer, schedule, slackEngine);
+	}
 
-				if (endTime < earliestEndTime) {
-					earliestEndTime = endTime;
-					sd.jobID = job.jobID;
-					sd.operationID = operation.operationID;
-					sd.stationID = operationStationTime.stationID;
-				}
-			}
-		}
-		return sd;
+	ConstructionSolver::ConstrutionFunction make_ELFT_Planner()
+	{
+		return [slackEngine = SlackEngine()](const JobContainer& jobContainer, const Schedule& schedule) mutable {
+			return elftDecision(jobContainer, schedule, slackEngine);
+		};
 	}
 
-	ScheduleDecision ELFT_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	ScheduleDecision elftDecision(const JobContainer& jobContainer, const Schedule& schedule, SlackEngine& slackEngine)
 	{
 		ScheduleDecision sd;
 		// all currently availible operation from all jobs
@@ -960,15 +1029,16 @@ namespace ConstructionAlgorithm {
 			for (const auto& operationID : jobAvbOps) avbOps.push_back({ operationID, job.jobID });
 		}
 
+		// ES / LF of all not done ops, refreshed only for jobs and stations that changed
+		slackEngine.sync(jobContainer, schedule);
+
 		// find which operation is shortest
 		float earliestEndTime = std::numeric_limits<int>::max();
 
 		for (auto& operationJobID : avbOps) {
 			const fjss::Job& job = jobContainer.getJob(operationJobID.second);
 			const fjss::Operation& operation = job.getOperation(operationJobID.first);
-			int LF = job.calculateLF(operation.operationID, schedule);
-			int ES = job.calculateES(operation.operationID, schedule);
-			int slack = LF - ES - operation.getShortestProcessTime();
+			int slack = slackEngine.slack(job.jobID, operation.operationID);
 			int altStations = operation.getOperationTimeStations().size();
 
 			for (auto& operationStationTime : operation.getOperationTimeStations()) {
@@ -1103,29 +1173,13 @@ namespace ConstructionAlgorithm {
 			// EET
 			return schedule.fastestEndTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
 		case 1:
-			// build station demand map
+			// station demand among not done ops
 		{
-			std::map<StationID, int> stationDemandMap;
-			float allOps = 0;
-			float tm = 0;
-			for (const auto& jobIT : jobContainer.getJobs()) {
-				const fjss::Job& job = jobIT.second;
-				const std::map<OperationID, Operation>& jobOperationsMap = job.getOperaions();
-				for (const auto& operationIT : jobOperationsMap) {
-					if (!operationIT.second.isDone()) {
-						for (auto& ots : operationIT.second.getOperationTimeStations()) {
-							++stationDemandMap[ots.stationID];
-							++allOps;
-						}
-						++tm;
-					}
-				}
-			}
-			//std::cout << stationDemandMap[ots.stationID] << " / " << allOps << "\n";
+			float tm = jobContainer.remainingOperationCount();
 			int envelope = schedule.makeSpan() - schedule.fastestEndTimeForScheduleOperation(ots.stationID, operation.operationID, job.jobID, jobContainer);
 			//return -envelope + ((float)stationDemandMap[ots.stationID] / allOps) * operation.averageProcessTime();
 			//return -envelope + ((float)stationDemandMap[ots.stationID] / tm) * operation.averageProcessTime();
-			return -envelope + ((float)stationDemandMap[ots.stationID] / tm) * ots.time;
+			return -envelope + ((float)jobContainer.getStationDemand(ots.stationID) / tm) * ots.time;
 		}
 		case 2:
 			// shortest processing time
@@ -2,14 +2,20 @@
 
 #include <limits>
 #include "FJSS.hpp"
+#include "SlackEngine.h"
+#include "Random.hpp"
 #include <functional>
+#include <optional>
+#include <memory>
+#include <atomic>
 
 using namespace fjss;
 
 namespace ConstructionAlgorithm {
-	extern int dispatch_operation_mode;
-	extern int dispatch_station_mode;
-	extern std::vector<double> params;
+	// per thread, so parallel runners can give every worker its own planner setup
+	extern thread_local int dispatch_operation_mode;
+	extern thread_local int dispatch_station_mode;
+	extern thread_local std::vector<double> params;
 
 	struct ScheduleDecision {
 		StationID stationID;
@@ -17,6 +23,30 @@ namespace ConstructionAlgorithm {
 		JobID jobID;
 	};
 
+	/* One pulled step: the planner decision and the operation it placed */
+	struct ScheduleStep {
+		ScheduleDecision decision;
+		ScheduledOperation scheduledOperation;
+	};
+
+	enum class SolveStatus {
+		Running,
+		Completed,
+		Dominated,	// lower bound reached the incumbent, schedule left partial
+		Cancelled	// cancellation token fired, schedule left partial
+	};
+
+	/* Copies share one flag, so a token handed to a solver can be cancelled from any thread */
+	class CancellationToken {
+	public:
+		CancellationToken() : m_cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+		void cancel() { m_cancelled->store(true, std::memory_order_relaxed); }
+		bool isCancelled() const { return m_cancelled->load(std::memory_order_relaxed); }
+
+	private:
+		std::shared_ptr<std::atomic<bool>> m_cancelled;
+	};
+
 	class ConstructionSolver {
 	public:
 		using ConstrutionFunction = std::function<ScheduleDecision(const JobContainer& jobContainer, const Schedule& schedule)>;
@@ -30,12 +60,37 @@ namespace ConstructionAlgorithm {
 		Schedule& getSchedule();
 		bool isDone();
 		void scheduleStep(int stepCount = 1);
-		void scheduleAll();
+		SolveStatus scheduleAll();
+
+		/* Pull one step, empty once the schedule is complete, dominated or cancelled */
+		std::optional<ScheduleStep> next();
+		/* Cooperative slice: pulls up to maxSteps, calling onStep for each.
+		   Returns false once there is nothing more to pull */
+		bool resume(int maxSteps, const std::function<void(const ScheduleStep&)>& onStep = nullptr);
+		void setCancellationToken(const CancellationToken& token);
+
+		/* scheduleAll aborts as Dominated once lowerBound() >= incumbent makeSpan */
+		void setIncumbent(int makeSpan);
+		int lowerBound();
+		SolveStatus getStatus() const;
 
 	private:
+		ScheduledOperation commitDecision(const ScheduleDecision& sd);
+		bool boundStale() const;
+		void resetBound();
+
 		JobContainer& jobContainer;
 		Schedule& schedule;
 		ConstrutionFunction constructionFunc;
+		std::optional<CancellationToken> cancellationToken;
+
+		int incumbent;
+		SolveStatus status;
+		// max over steps of (scheduled op end + critical path after it), restarted with the container
+		// and recomputed when the schedule was unstacked below boundDepth
+		int jobBound;
+		uint64_t boundStamp;
+		size_t boundDepth;
 	};
 
 
@@ -56,6 +111,26 @@ namespace ConstructionAlgorithm {
 
 
 
+	/* max(partial makespan, remaining shortest work spread over the stations after their availability) */
+	int loadLowerBound(const JobContainer& jobContainer, const Schedule& schedule);
+	/* max over availible operations of ready time + critical path from them */
+	int jobLowerBound(const JobContainer& jobContainer);
+	/* End of a stacked operation + critical path after it. A running max of it from jobLowerBound on
+	   is the job part of ConstructionSolver::lowerBound, for loops that stack without a solver */
+	int stackedJobBound(const JobContainer& jobContainer, const ScheduledOperation& sop);
+	/* Decisions of a schedule in stacking order (start time order if it has no stacking record);
+	   stacking them onto a restarted container rebuilds the same schedule */
+	void stackedDecisions(const Schedule& schedule, std::vector<ScheduleDecision>& decisions);
+
+
+
+	/* Round robin over many solvers on the calling thread, stepsPerTurn pulls each turn (at least 1),
+	   until all of them stop */
+	void runInterleaved(const std::vector<ConstructionSolver*>& solvers, int stepsPerTurn,
+		const std::function<void(size_t solverIndex, const ScheduleStep&)>& onStep = nullptr);
+
+
+
 	// Dispatch heuristics
 	/* Most successors + earliest end time */
 	ScheduleDecision MS_EET_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 1505.28
@@ -72,6 +147,10 @@ namespace ConstructionAlgorithm {
 	// Flops/  experimentals:
 	/* Slack = LF - ES then EET = Hybrid ELFT-Slack*/
 	ScheduleDecision ELFT_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 1565.91
+	/* ELFT with its own engine, give every solver its own one */
+	ConstructionSolver::ConstrutionFunction make_ELFT_Planner();
+	/* ELFT decision keeping ES / LF in the caller's engine between calls */
+	ScheduleDecision elftDecision(const JobContainer& jobContainer, const Schedule& schedule, SlackEngine& slackEngine);
 	/* Non correct Critical Path */
 	ScheduleDecision NC_CP_Planner(const JobContainer& jobContainer, const Schedule& schedule);
 	/* Heuristic Function Manual-tuned parameters */
@@ -81,8 +160,10 @@ namespace ConstructionAlgorithm {
 	ScheduleDecision MD_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 1633.85
 	/* Least alternative + most successors + Time blocked by operation */
 	ScheduleDecision TBOP_LA_EET_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 1630.81
-	/* Random dispatch algorithm */
-	ScheduleDecision RNG_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 2420.25
+	/* Random dispatch algorithm with its own generator, make one per config / run so a fixed seed
+	   gives the same schedules whichever thread runs it */
+	ConstructionSolver::ConstrutionFunction make_RNG_Planner(uint64_t seed); // 2420.25
+	ScheduleDecision randomDecision(const JobContainer& jobContainer, Xoshiro256& rng);
 
 
 	/* 2 poziomowe algorytmy */
@@ -120,5 +201,29 @@ namespace ConstructionAlgorithm {
 	// Weaker hybrid algos:
 	/* Most work remaining (sum of avg operation time) + Earliest end time algorithm */
 	ScheduleDecision MWKR_Planner(const JobContainer& jobContainer, const Schedule& schedule); // 1362.19
+
+
+
+	// Candidate scores (lower is better) for search methods that need more than the single best decision.
+	// Candidates are collected in the planners' scan order, so the first lowest one is the planner's pick.
+	struct ScoredDecision {
+		ScheduleDecision decision;
+		float score;
+	};
+	using CandidateScorer = std::function<float(const JobContainer& jobContainer, const Schedule& schedule,
+		const Job& job, const Operation& operation, const OperationTimeStation& ots)>;
+
+	/* Every (availible operation, station) pair with its score, appended to candidates after clearing it */
+	void collectCandidates(const JobContainer& jobContainer, const Schedule& schedule, const CandidateScorer& scorer,
+		std::vector<ScoredDecision>& candidates);
+	/* Keeps the count lowest, ordered by score, ties in scan order */
+	void keepBestCandidates(std::vector<ScoredDecision>& candidates, size_t count);
+
+	float EIT_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
+	float EET_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
+	float HF2_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
+	float TBOP_HF_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
+	float CP_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
+	float CP_HF_Score(const JobContainer& jobContainer, const Schedule& schedule, const Job& job, const Operation& operation, const OperationTimeStation& ots);
 }
 
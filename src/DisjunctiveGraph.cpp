@@ -0,0 +1,354 @@
+#include "DisjunctiveGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ConstructionAlgorithm {
+	DisjunctiveGraph::DisjunctiveGraph(const JobContainer& instance, const Schedule& schedule)
+	{
+		for (const auto& jobIT : instance.getJobs()) {
+			const Job& job = jobIT.second;
+			if (m_nodeIndex.size() <= jobIT.first) m_nodeIndex.resize(jobIT.first + 1);
+			OperationID lastID = job.getOperaions().empty() ? 0 : job.getOperaions().rbegin()->first;
+			m_nodeIndex[jobIT.first].assign(lastID + 1, -1);
+			for (const auto& operationIT : job.getOperaions()) {
+				m_nodeIndex[jobIT.first][operationIT.first] = (int)m_jobID.size();
+				m_jobID.push_back(jobIT.first);
+				m_operationID.push_back(operationIT.first);
+			}
+		}
+
+		size_t nodeCount = m_jobID.size();
+		m_jobPredecessorBegin.push_back(0);
+		m_jobSuccessorBegin.push_back(0);
+		m_alternativeBegin.push_back(0);
+		for (size_t node = 0; node < nodeCount; ++node) {
+			const Job& job = instance.getJob(m_jobID[node]);
+			const Operation& operation = job.getOperation(m_operationID[node]);
+			for (OperationID predecessorID : operation.getPredecessors()) {
+				m_jobPredecessors.push_back(m_nodeIndex[m_jobID[node]][predecessorID]);
+			}
+			for (OperationID successorID : job.getSuccessors(m_operationID[node])) {
+				m_jobSuccessors.push_back(m_nodeIndex[m_jobID[node]][successorID]);
+			}
+			for (const OperationTimeStation& ots : operation.getOperationTimeStations()) m_alternatives.push_back(ots);
+			m_jobPredecessorBegin.push_back(m_jobPredecessors.size());
+			m_jobSuccessorBegin.push_back(m_jobSuccessors.size());
+			m_alternativeBegin.push_back(m_alternatives.size());
+		}
+
+		m_station.assign(nodeCount, 0);
+		m_time.assign(nodeCount, 0);
+		m_position.assign(nodeCount, 0);
+		m_sequences.assign(schedule.stationCount(), std::vector<int>());
+		std::vector<char> scheduled(nodeCount, 0);
+		const std::vector<std::vector<ScheduledOperation>>& stations = schedule.getSchedule();
+		for (StationID stationID = 0; stationID < stations.size(); ++stationID) {
+			for (const ScheduledOperation& sop : stations[stationID]) {
+				bool known = sop.jobID < m_nodeIndex.size() && sop.operationID < m_nodeIndex[sop.jobID].size() &&
+					m_nodeIndex[sop.jobID][sop.operationID] != -1;
+				if (!known) throw std::runtime_error("DisjunctiveGraph: schedule holds an operation the instance doesn't have");
+				int node = m_nodeIndex[sop.jobID][sop.operationID];
+				if (scheduled[node]) throw std::runtime_error("DisjunctiveGraph: operation scheduled twice");
+				scheduled[node] = 1;
+				m_station[node] = stationID;
+				m_time[node] = sop.duration;
+				m_position[node] = m_sequences[stationID].size();
+				m_sequences[stationID].push_back(node);
+			}
+		}
+		if (std::find(scheduled.begin(), scheduled.end(), 0) != scheduled.end()) {
+			throw std::runtime_error("DisjunctiveGraph: schedule doesn't cover the instance");
+		}
+		m_previous.assign(nodeCount, -1);
+		m_next.assign(nodeCount, -1);
+		for (StationID stationID = 0; stationID < m_sequences.size(); ++stationID) linkSequence(stationID, 0);
+
+		m_head.assign(nodeCount, 0);
+		m_tail.assign(nodeCount, 0);
+		m_jobReady.assign(nodeCount, 0);
+		m_jobTail.assign(nodeCount, 0);
+		m_inDegree.assign(nodeCount, 0);
+		m_rank.assign(nodeCount, 0);
+		m_mark.assign(nodeCount, 0);
+		m_order.reserve(nodeCount);
+		if (!evaluate()) throw std::runtime_error("DisjunctiveGraph: schedule is cyclic");
+	}
+
+	bool DisjunctiveGraph::evaluate()
+	{
+		size_t nodeCount = m_station.size();
+		m_order.clear();
+		for (size_t node = 0; node < nodeCount; ++node) {
+			m_inDegree[node] = (int)(m_jobPredecessorBegin[node + 1] - m_jobPredecessorBegin[node]) + (m_previous[node] != -1 ? 1 : 0);
+			if (m_inDegree[node] == 0) m_order.push_back((int)node);
+		}
+
+		// Kahn, heads are final once a node is taken
+		for (size_t i = 0; i < m_order.size(); ++i) {
+			int node = m_order[i];
+			int ready = 0;
+			for (const int* p = jobPredecessorsBegin(node); p != jobPredecessorsEnd(node); ++p) ready = std::max(ready, end(*p));
+			m_jobReady[node] = ready;
+			int machine = stationPredecessor(node);
+			m_head[node] = machine == -1 ? ready : std::max(ready, end(machine));
+
+			for (const int* s = jobSuccessorsBegin(node); s != jobSuccessorsEnd(node); ++s) {
+				if (--m_inDegree[*s] == 0) m_order.push_back(*s);
+			}
+			int next = stationSuccessor(node);
+			if (next != -1 && --m_inDegree[next] == 0) m_order.push_back(next);
+		}
+		if (m_order.size() != nodeCount) return false;
+
+		m_makeSpan = 0;
+		for (size_t i = nodeCount; i-- > 0;) {
+			int node = m_order[i];
+			m_rank[node] = (int)i;
+			int after = 0;
+			for (const int* s = jobSuccessorsBegin(node); s != jobSuccessorsEnd(node); ++s) after = std::max(after, m_time[*s] + m_tail[*s]);
+			m_jobTail[node] = after;
+			int next = stationSuccessor(node);
+			m_tail[node] = next == -1 ? after : std::max(after, m_time[next] + m_tail[next]);
+			m_makeSpan = std::max(m_makeSpan, end(node));
+		}
+		return true;
+	}
+
+	void DisjunctiveGraph::linkSequence(StationID stationID, size_t from)
+	{
+		const std::vector<int>& sequence = m_sequences[stationID];
+		for (size_t i = from > 0 ? from - 1 : 0; i < sequence.size(); ++i) {
+			m_position[sequence[i]] = i;
+			m_previous[sequence[i]] = i > 0 ? sequence[i - 1] : -1;
+			m_next[sequence[i]] = i + 1 < sequence.size() ? sequence[i + 1] : -1;
+		}
+	}
+
+	void DisjunctiveGraph::moveOperation(int node, StationID stationID, size_t position)
+	{
+		int time = -1;
+		for (const OperationTimeStation* ots = alternativesBegin(node); ots != alternativesEnd(node); ++ots) {
+			if (ots->stationID == stationID) time = ots->time;
+		}
+		if (time == -1) throw std::runtime_error("DisjunctiveGraph: station can't process the operation");
+
+		StationID fromStation = m_station[node];
+		size_t fromPosition = m_position[node];
+		std::vector<int>& from = m_sequences[fromStation];
+		from.erase(from.begin() + fromPosition);
+		linkSequence(fromStation, fromPosition);
+
+		std::vector<int>& to = m_sequences[stationID];
+		position = std::min(position, to.size());
+		to.insert(to.begin() + position, node);
+		m_station[node] = stationID;
+		m_time[node] = time;
+		linkSequence(stationID, position);
+	}
+
+	bool DisjunctiveGraph::applyMove(int node, StationID stationID, size_t position)
+	{
+		StationID oldStation = m_station[node];
+		size_t oldPosition = m_position[node];
+		int oldPrevious = m_previous[node];
+		int oldNext = m_next[node];
+		moveOperation(node, stationID, position);
+		int previous = m_previous[node];
+		int next = m_next[node];
+
+		// oldPrevious -> oldNext already respects the order, only the arcs into and out of node can break it
+		if ((previous != -1 && !repairOrder(previous, node)) || (next != -1 && !repairOrder(node, next))) {
+			moveOperation(node, oldStation, oldPosition);
+			evaluate();
+			return false;
+		}
+
+		int headSeeds[] = { node, oldNext, next };
+		int tailSeeds[] = { node, oldPrevious, previous };
+		updateHeads(headSeeds, 3);
+		updateTails(tailSeeds, 3);
+		m_makeSpan = 0;
+		for (size_t i = 0; i < m_station.size(); ++i) m_makeSpan = std::max(m_makeSpan, m_head[i] + m_time[i]);
+		return true;
+	}
+
+	bool DisjunctiveGraph::repairOrder(int from, int to)
+	{
+		int lower = m_rank[to];
+		int upper = m_rank[from];
+		if (lower > upper) return true;
+
+		// nodes reachable from to inside the broken window, a cycle if from is among them
+		m_forward.clear();
+		m_stack.assign(1, to);
+		m_mark[to] = 1;
+		bool cycle = false;
+		while (!m_stack.empty()) {
+			int node = m_stack.back();
+			m_stack.pop_back();
+			m_forward.push_back(node);
+			auto visit = [&](int successor) {
+				if (successor == from) cycle = true;
+				if (!m_mark[successor] && m_rank[successor] < upper) {
+					m_mark[successor] = 1;
+					m_stack.push_back(successor);
+				}
+			};
+			for (const int* s = jobSuccessorsBegin(node); s != jobSuccessorsEnd(node); ++s) visit(*s);
+			if (m_next[node] != -1) visit(m_next[node]);
+		}
+		for (int node : m_forward) m_mark[node] = 0;
+		if (cycle) return false;
+
+		// nodes leading to from inside the window
+		m_backward.clear();
+		m_stack.assign(1, from);
+		m_mark[from] = 1;
+		while (!m_stack.empty()) {
+			int node = m_stack.back();
+			m_stack.pop_back();
+			m_backward.push_back(node);
+			auto visit = [&](int predecessor) {
+				if (!m_mark[predecessor] && m_rank[predecessor] > lower) {
+					m_mark[predecessor] = 1;
+					m_stack.push_back(predecessor);
+				}
+			};
+			for (const int* p = jobPredecessorsBegin(node); p != jobPredecessorsEnd(node); ++p) visit(*p);
+			if (m_previous[node] != -1) visit(m_previous[node]);
+		}
+		for (int node : m_backward) m_mark[node] = 0;
+
+		// the same ranks handed out again, backward set first, each set keeping its relative order
+		auto byRank = [&](int a, int b) { return m_rank[a] < m_rank[b]; };
+		std::sort(m_backward.begin(), m_backward.end(), byRank);
+		std::sort(m_forward.begin(), m_forward.end(), byRank);
+		m_ranks.clear();
+		for (int node : m_backward) m_ranks.push_back(m_rank[node]);
+		for (int node : m_forward) m_ranks.push_back(m_rank[node]);
+		std::sort(m_ranks.begin(), m_ranks.end());
+		size_t i = 0;
+		for (int node : m_backward) m_rank[node] = m_ranks[i++];
+		for (int node : m_forward) m_rank[node] = m_ranks[i++];
+		for (int node : m_backward) m_order[m_rank[node]] = node;
+		for (int node : m_forward) m_order[m_rank[node]] = node;
+		return true;
+	}
+
+	void DisjunctiveGraph::updateHeads(const int* seeds, size_t seedCount)
+	{
+		// sweep forward from the first seed, recomputing only nodes behind a change
+		int start = (int)m_order.size();
+		for (size_t i = 0; i < seedCount; ++i) {
+			if (seeds[i] == -1) continue;
+			m_mark[seeds[i]] = 2;	// always propagates (time or arcs of the node changed)
+			start = std::min(start, m_rank[seeds[i]]);
+		}
+		for (size_t i = start; i < m_order.size(); ++i) {
+			int node = m_order[i];
+			if (!m_mark[node]) continue;
+			bool force = m_mark[node] == 2;
+			m_mark[node] = 0;
+			int ready = 0;
+			for (const int* p = jobPredecessorsBegin(node); p != jobPredecessorsEnd(node); ++p) ready = std::max(ready, end(*p));
+			int head = m_previous[node] == -1 ? ready : std::max(ready, end(m_previous[node]));
+			m_jobReady[node] = ready;
+			if (head == m_head[node] && !force) continue;
+			m_head[node] = head;
+			for (const int* s = jobSuccessorsBegin(node); s != jobSuccessorsEnd(node); ++s) {
+				if (!m_mark[*s]) m_mark[*s] = 1;
+			}
+			if (m_next[node] != -1 && !m_mark[m_next[node]]) m_mark[m_next[node]] = 1;
+		}
+	}
+
+	void DisjunctiveGraph::updateTails(const int* seeds, size_t seedCount)
+	{
+		int start = -1;
+		for (size_t i = 0; i < seedCount; ++i) {
+			if (seeds[i] == -1) continue;
+			m_mark[seeds[i]] = 2;
+			start = std::max(start, m_rank[seeds[i]]);
+		}
+		for (int i = start; i >= 0; --i) {
+			int node = m_order[i];
+			if (!m_mark[node]) continue;
+			bool force = m_mark[node] == 2;
+			m_mark[node] = 0;
+			int after = 0;
+			for (const int* s = jobSuccessorsBegin(node); s != jobSuccessorsEnd(node); ++s) after = std::max(after, m_time[*s] + m_tail[*s]);
+			int tail = m_next[node] == -1 ? after : std::max(after, m_time[m_next[node]] + m_tail[m_next[node]]);
+			m_jobTail[node] = after;
+			if (tail == m_tail[node] && !force) continue;
+			m_tail[node] = tail;
+			for (const int* p = jobPredecessorsBegin(node); p != jobPredecessorsEnd(node); ++p) {
+				if (!m_mark[*p]) m_mark[*p] = 1;
+			}
+			if (m_previous[node] != -1 && !m_mark[m_previous[node]]) m_mark[m_previous[node]] = 1;
+		}
+	}
+
+	bool DisjunctiveGraph::canMoveBehind(int u, int v) const
+	{
+		for (const int* s = jobSuccessorsBegin(u); s != jobSuccessorsEnd(u); ++s) {
+			if (*s == v || m_tail[*s] >= m_time[v] + m_tail[v]) return false;
+		}
+		return true;
+	}
+
+	bool DisjunctiveGraph::canMoveBefore(int v, int u) const
+	{
+		for (const int* p = jobPredecessorsBegin(v); p != jobPredecessorsEnd(v); ++p) {
+			if (*p == u || m_head[*p] >= m_head[u] + m_time[u]) return false;
+		}
+		return true;
+	}
+
+	void DisjunctiveGraph::criticalPath(std::vector<int>& path) const
+	{
+		path.clear();
+		int node = -1;
+		for (size_t i = 0; i < m_station.size(); ++i) {
+			if (end((int)i) == m_makeSpan && (node == -1 || m_head[i] < m_head[node])) node = (int)i;
+		}
+		// walk back over tight arcs, machine arcs first so blocks come out as long as possible
+		while (node != -1) {
+			path.push_back(node);
+			int previous = -1;
+			int machine = stationPredecessor(node);
+			if (machine != -1 && end(machine) == m_head[node]) previous = machine;
+			else {
+				for (const int* p = jobPredecessorsBegin(node); p != jobPredecessorsEnd(node); ++p) {
+					if (end(*p) == m_head[node]) {
+						previous = *p;
+						break;
+					}
+				}
+			}
+			node = previous;
+		}
+		std::reverse(path.begin(), path.end());
+	}
+
+	void DisjunctiveGraph::criticalBlocks(const std::vector<int>& path, std::vector<std::vector<int>>& blocks) const
+	{
+		blocks.clear();
+		for (size_t i = 0; i < path.size(); ++i) {
+			bool extends = i > 0 && m_station[path[i]] == m_station[path[i - 1]] && m_position[path[i]] == m_position[path[i - 1]] + 1;
+			if (!extends) blocks.emplace_back();
+			blocks.back().push_back(path[i]);
+		}
+	}
+
+	Schedule DisjunctiveGraph::toSchedule(const JobContainer& instance) const
+	{
+		// the topological order visits every station in sequence order, so stacking it reproduces the heads
+		JobContainer jobContainer = instance;
+		jobContainer.restartContainer();
+		Schedule schedule(m_sequences.size());
+		for (int node : m_order) {
+			schedule.stackScheduleOperation(m_station[node], m_operationID[node], m_jobID[node], jobContainer);
+		}
+		return schedule;
+	}
+}
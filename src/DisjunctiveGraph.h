@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+
+namespace ConstructionAlgorithm {
+	/* Finished schedule as a disjunctive graph: every operation is a node with job arcs from its
+	   predecessors and a machine arc from the operation before it on its station. Heads are earliest
+	   starts, tails the longest path after a node's end, so head + time + tail through any node is the
+	   longest path it lies on and the makespan is the largest of them.
+	   Moves only change the station sequences; evaluate() recomputes heads and tails in one topological
+	   pass and toSchedule() gives the semi-active schedule back. */
+	class DisjunctiveGraph {
+	public:
+		DisjunctiveGraph() = default;
+		DisjunctiveGraph(const JobContainer& instance, const Schedule& schedule);
+
+		size_t nodeCount() const { return m_station.size(); }
+		size_t stationCount() const { return m_sequences.size(); }
+
+		/* heads, tails and makespan, false when the sequences contain a cycle */
+		bool evaluate();
+		int makeSpan() const { return m_makeSpan; }
+
+		JobID jobID(int node) const { return m_jobID[node]; }
+		OperationID operationID(int node) const { return m_operationID[node]; }
+		StationID station(int node) const { return m_station[node]; }
+		int time(int node) const { return m_time[node]; }
+		int head(int node) const { return m_head[node]; }
+		int tail(int node) const { return m_tail[node]; }
+		int end(int node) const { return m_head[node] + m_time[node]; }
+		/* max end of the job predecessors / max time + tail of the job successors */
+		int jobReady(int node) const { return m_jobReady[node]; }
+		int jobTail(int node) const { return m_jobTail[node]; }
+
+		size_t position(int node) const { return m_position[node]; }
+		const std::vector<int>& sequence(StationID stationID) const { return m_sequences[stationID]; }
+		int stationPredecessor(int node) const { return m_previous[node]; }
+		int stationSuccessor(int node) const { return m_next[node]; }
+
+		/* node range in the CSR arrays */
+		const int* jobPredecessorsBegin(int node) const { return m_jobPredecessors.data() + m_jobPredecessorBegin[node]; }
+		const int* jobPredecessorsEnd(int node) const { return m_jobPredecessors.data() + m_jobPredecessorBegin[node + 1]; }
+		const int* jobSuccessorsBegin(int node) const { return m_jobSuccessors.data() + m_jobSuccessorBegin[node]; }
+		const int* jobSuccessorsEnd(int node) const { return m_jobSuccessors.data() + m_jobSuccessorBegin[node + 1]; }
+		const OperationTimeStation* alternativesBegin(int node) const { return m_alternatives.data() + m_alternativeBegin[node]; }
+		const OperationTimeStation* alternativesEnd(int node) const { return m_alternatives.data() + m_alternativeBegin[node + 1]; }
+		int node(JobID jobID, OperationID operationID) const { return m_nodeIndex[jobID][operationID]; }
+
+		/* takes the node off its station and puts it at position of the target station's sequence
+		   (position counted without the node), heads and tails are stale until evaluate() */
+		void moveOperation(int node, StationID stationID, size_t position);
+		/* moveOperation plus an incremental evaluate(): the topological order is repaired around the two
+		   new station arcs (Pearce-Kelly) and heads/tails are only recomputed where they change.
+		   Needs a graph that was evaluated; on a cycle the move is taken back and false returned. */
+		bool applyMove(int node, StationID stationID, size_t position);
+
+		/* moving u behind v on their station (u before v) can't close a cycle: no job successor of u leads to v */
+		bool canMoveBehind(int u, int v) const;
+		/* moving v in front of u on their station (u before v) can't close a cycle: u leads to no job predecessor of v */
+		bool canMoveBefore(int v, int u) const;
+
+		/* one longest path, source to sink */
+		void criticalPath(std::vector<int>& path) const;
+		/* maximal runs of the critical path that follow each other on one station */
+		void criticalBlocks(const std::vector<int>& path, std::vector<std::vector<int>>& blocks) const;
+
+		Schedule toSchedule(const JobContainer& instance) const;
+
+	private:
+		std::vector<JobID> m_jobID;
+		std::vector<OperationID> m_operationID;
+		std::vector<std::vector<int>> m_nodeIndex;	// [jobID][operationID]
+		std::vector<size_t> m_jobPredecessorBegin, m_jobSuccessorBegin, m_alternativeBegin;
+		std::vector<int> m_jobPredecessors, m_jobSuccessors;
+		std::vector<OperationTimeStation> m_alternatives;
+
+		std::vector<StationID> m_station;
+		std::vector<int> m_time;
+		std::vector<size_t> m_position;
+		std::vector<std::vector<int>> m_sequences;
+		std::vector<int> m_previous, m_next;	// station neighbours, -1 at the ends
+
+		void linkSequence(StationID stationID, size_t from);
+		bool repairOrder(int from, int to);
+		void updateHeads(const int* seeds, size_t seedCount);
+		void updateTails(const int* seeds, size_t seedCount);
+
+		std::vector<int> m_head, m_tail, m_jobReady, m_jobTail;
+		std::vector<int> m_order;		// topological order of the last evaluate() / applyMove()
+		std::vector<int> m_rank;		// position in m_order
+		std::vector<int> m_inDegree;
+		std::vector<char> m_mark;
+		std::vector<int> m_stack, m_forward, m_backward, m_ranks;
+		int m_makeSpan = 0;
+	};
+}
@@ -1,10 +1,14 @@
 #include "FJSS.hpp"
+#include <atomic>
 
 namespace fjss {
+    static std::atomic<uint64_t> g_restartCounter{ 0 };
+
     Operation::Operation() {
         operationID = 0;
         operationTypeID = 0;
         m_lastPrecedessorTime = 0;
+        m_predecessorsToDo = 0;
         m_done = false;
     }
 
@@ -17,21 +21,26 @@ namespace fjss {
     }
 
     void Operation::restartOperation() {
-        m_predecessorsToDo.clear();
-        for (const auto& it : m_predecessors) m_predecessorsToDo.insert(it);
+        m_predecessorsToDo = m_predecessors.size();
         m_lastPrecedessorTime = 0;
         m_done = false;
     }
 
     bool Operation::isAvailible() const {
-        return m_predecessorsToDo.empty();
+        return m_predecessorsToDo == 0;
     }
 
-    void Operation::precedessordoneUpdate(OperationID predecessorID, int time) {
-        m_predecessorsToDo.erase(predecessorID);
+    void Operation::precedessordoneUpdate(int time) {
+        // every predecessor is dumped once, counting is enough
+        --m_predecessorsToDo;
         m_lastPrecedessorTime = std::max(m_lastPrecedessorTime, time);
     }
 
+    void Operation::precedessorUndoUpdate(int previousLastPrecedessorTime) {
+        ++m_predecessorsToDo;
+        m_lastPrecedessorTime = previousLastPrecedessorTime;
+    }
+
     int Operation::getLastPrecedessorTime() const {
         return m_lastPrecedessorTime;
     }
@@ -49,6 +58,10 @@ namespace fjss {
         m_done = true;
     }
 
+    void Operation::markUndone() {
+        m_done = false;
+    }
+
     bool Operation::isDone() const {
         return m_done;
     }
@@ -85,18 +98,33 @@ namespace fjss {
     Job::Job(JobID jobID) {
         this->jobID = jobID;
         jobTypeID = 0;
+        m_remainingOperations = 0;
+        m_version = 0;
     }
 
     void Job::restartJob() {
         m_availibleOperations.clear();
+        m_remainingOperations = m_operations.size();
+        ++m_version;
         for (auto& it : m_operations) {
             it.second.restartOperation();
             if (it.second.isAvailible()) m_availibleOperations.push_back(it.first);
         }
+        if (!m_structureCached) {
+            for (auto& it : m_operations) {
+                cacheCriticalPath(it.first);
+                cacheTimeBlocked(it.first);
+            }
+            m_structureCached = true;
+        }
     }
 
     void Job::addOperation(const Operation& operation) {
         m_operations.insert({ operation.operationID, operation });
+        m_criticalPaths.clear();
+        m_timeBlocked.clear();
+        m_structureCached = false;
+        m_remainingOperations = m_operations.size();
         if (m_successors.count(operation.operationID) == 0) {
             m_successors.insert({ operation.operationID, std::vector<OperationID>() });
         }
@@ -109,16 +137,20 @@ namespace fjss {
         for (const Operation& operation : operations) addOperation(operation);
     }
 
-    bool Job::dumpOperation(OperationID operationID, int endTime) {
+    bool Job::dumpOperation(OperationID operationID, int endTime, size_t* availiblePos, std::vector<int>* previousSuccessorTimes) {
         auto idItr = std::find(m_availibleOperations.begin(), m_availibleOperations.end(), operationID);
         if (idItr == m_availibleOperations.end()) {
             return false;
         }
+        if (availiblePos) *availiblePos = idItr - m_availibleOperations.begin();
         m_availibleOperations.erase(idItr);
         m_operations[operationID].markDone();
+        --m_remainingOperations;
+        ++m_version;
         // infrom all succesors and check their avibility
         for (auto& successorOpID : m_successors[operationID]) {
-            m_operations[successorOpID].precedessordoneUpdate(operationID, endTime);
+            if (previousSuccessorTimes) previousSuccessorTimes->push_back(m_operations[successorOpID].getLastPrecedessorTime());
+            m_operations[successorOpID].precedessordoneUpdate(endTime);
             if (m_operations[successorOpID].isAvailible()) {
                 m_availibleOperations.push_back(successorOpID);
             }
@@ -126,6 +158,22 @@ namespace fjss {
         return true;
     }
 
+    void Job::undoOperation(OperationID operationID, size_t availiblePos, const int* previousSuccessorTimes) {
+        // successors released by the dump were appended in successor order, nothing was dumped since
+        const std::vector<OperationID>& successors = m_successors[operationID];
+        size_t released = 0;
+        for (size_t i = 0; i < successors.size(); ++i) {
+            Operation& successor = m_operations[successors[i]];
+            if (successor.isAvailible()) ++released;
+            successor.precedessorUndoUpdate(previousSuccessorTimes[i]);
+        }
+        m_availibleOperations.resize(m_availibleOperations.size() - released);
+        m_availibleOperations.insert(m_availibleOperations.begin() + availiblePos, operationID);
+        m_operations[operationID].markUndone();
+        ++m_remainingOperations;
+        ++m_version;
+    }
+
     const Operation& Job::getOperation(OperationID operationID) const {
         return m_operations.at(operationID);
     }
@@ -150,6 +198,8 @@ namespace fjss {
 
     float Job::avgTimeBlockedByOperation(OperationID operationID) const
     {
+        auto cached = m_timeBlocked.find(operationID);
+        if (cached != m_timeBlocked.end()) return cached->second;
         float avgTimeBlocked = 0;
         const std::vector<OperationID>& successors = getSuccessors(operationID);
         if (successors.empty()) return 0;
@@ -189,8 +239,10 @@ namespace fjss {
 
     float Job::criticalPath(OperationID operationID) const
     {
+        auto cached = m_criticalPaths.find(operationID);
+        if (cached != m_criticalPaths.end()) return cached->second;
         const Operation& operation = m_operations.at(operationID);
-        const std::vector<OperationID> successors = m_successors.at(operationID);
+        const std::vector<OperationID>& successors = m_successors.at(operationID);
         float cpl = 0;
         for (const OperationID successorID : successors) {
             cpl = std::max(cpl, criticalPath(successorID));
@@ -199,10 +251,37 @@ namespace fjss {
         //return cpl + operation.getLongestProcessTime();
     }
 
+    // same arithmetic as criticalPath / avgTimeBlockedByOperation, every operation visited once
+    float Job::cacheCriticalPath(OperationID operationID)
+    {
+        auto cached = m_criticalPaths.find(operationID);
+        if (cached != m_criticalPaths.end()) return cached->second;
+        float cpl = 0;
+        for (const OperationID successorID : m_successors.at(operationID)) {
+            cpl = std::max(cpl, cacheCriticalPath(successorID));
+        }
+        cpl = cpl + m_operations.at(operationID).getShortestProcessTime();
+        m_criticalPaths[operationID] = cpl;
+        return cpl;
+    }
+
+    float Job::cacheTimeBlocked(OperationID operationID)
+    {
+        auto cached = m_timeBlocked.find(operationID);
+        if (cached != m_timeBlocked.end()) return cached->second;
+        float avgTimeBlocked = 0;
+        for (const OperationID& successorID : m_successors.at(operationID)) {
+            avgTimeBlocked += m_operations.at(successorID).averageProcessTime();
+            avgTimeBlocked += cacheTimeBlocked(successorID);
+        }
+        m_timeBlocked[operationID] = avgTimeBlocked;
+        return avgTimeBlocked;
+    }
+
     int Job::calculateLF(OperationID operationID, const Schedule& schedule) const
     {
         const Operation& operation = m_operations.at(operationID);
-        const std::vector<OperationID> successors = m_successors.at(operationID);
+        const std::vector<OperationID>& successors = m_successors.at(operationID);
         if (successors.empty()) {
             return schedule.makeSpan();
         }
@@ -234,12 +313,13 @@ namespace fjss {
                 return std::max(schedule.getStationAvabilityTime(ots.stationID), maxEF);
             }
         }
+        return maxEF;
     }
 
     int Job::getSuccessorsUpstream(OperationID operationID) const
     {
         const Operation& operation = m_operations.at(operationID);
-        const std::vector<OperationID> successors = m_successors.at(operationID);
+        const std::vector<OperationID>& successors = m_successors.at(operationID);
         if (successors.empty()) return 0;
         int suc = 0;
         for (const OperationID successorID : successors) {
@@ -250,18 +330,28 @@ namespace fjss {
 
     int Job::remainingNumOfOperations() const
     {
-        int remaining = 0;
-        for (const auto& it : m_operations) {
-            if (it.second.isDone()) continue;
-            ++remaining;
-        }
-        return remaining;
+        return m_remainingOperations;
     }
 
 
 
     //------------------------------
 
+    JobContainer::Stamp::Stamp(const Stamp&) {
+        value = ++g_restartCounter;
+    }
+
+    JobContainer::Stamp& JobContainer::Stamp::operator=(const Stamp&) {
+        value = ++g_restartCounter;
+        return *this;
+    }
+
+    JobContainer::JobContainer() {
+        m_stationCount = 0;
+        m_remainingOperations = 0;
+        m_remainingShortestWork = 0;
+    }
+
     void JobContainer::addJob(const Job& job) {
         m_jobs.insert({ job.jobID, job });
     }
@@ -287,11 +377,67 @@ namespace fjss {
     }
 
     void JobContainer::restartContainer() {
+        StationID stationSlots = std::max(m_stationCount, 0);
         for (auto& jobIT : m_jobs) {
             jobIT.second.restartJob();
+            for (const auto& operationIT : jobIT.second.getOperaions()) {
+                for (const OperationTimeStation& ots : operationIT.second.getOperationTimeStations()) {
+                    stationSlots = std::max(stationSlots, ots.stationID + 1);
+                }
+            }
+        }
+        // rebuild station demand from scratch, later kept up to date by dumpOperation
+        m_stationDemand.assign(stationSlots, 0);
+        m_remainingOperations = 0;
+        m_remainingShortestWork = 0;
+        m_restartStamp.value = ++g_restartCounter;
+        m_undoTrail.clear();
+        m_undoSuccessorTimes.clear();
+        for (const auto& jobIT : m_jobs) {
+            for (const auto& operationIT : jobIT.second.getOperaions()) {
+                for (const OperationTimeStation& ots : operationIT.second.getOperationTimeStations()) {
+                    ++m_stationDemand[ots.stationID];
+                }
+                ++m_remainingOperations;
+                m_remainingShortestWork += operationIT.second.getShortestProcessTime();
+            }
         }
     }
 
+    bool JobContainer::dumpOperation(JobID jobID, OperationID operationID, int endTime) {
+        Job& job = m_jobs.at(jobID);
+        UndoEntry entry{ jobID, operationID, 0, m_undoSuccessorTimes.size() };
+        if (!job.dumpOperation(operationID, endTime, &entry.availiblePos, &m_undoSuccessorTimes)) {
+            return false;
+        }
+        m_undoTrail.push_back(entry);
+        const Operation& operation = job.getOperation(operationID);
+        for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+            --m_stationDemand[ots.stationID];
+        }
+        --m_remainingOperations;
+        m_remainingShortestWork -= operation.getShortestProcessTime();
+        return true;
+    }
+
+    void JobContainer::undoOperation(JobID jobID, OperationID operationID) {
+        if (m_undoTrail.empty() || m_undoTrail.back().jobID != jobID || m_undoTrail.back().operationID != operationID) {
+            throw std::runtime_error("Operation undone out of order");
+        }
+        const UndoEntry& entry = m_undoTrail.back();
+        Job& job = m_jobs.at(jobID);
+        job.undoOperation(operationID, entry.availiblePos, m_undoSuccessorTimes.data() + entry.successorTimesBegin);
+        m_undoSuccessorTimes.resize(entry.successorTimesBegin);
+        m_undoTrail.pop_back();
+
+        const Operation& operation = job.getOperation(operationID);
+        for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+            ++m_stationDemand[ots.stationID];
+        }
+        ++m_remainingOperations;
+        m_remainingShortestWork += operation.getShortestProcessTime();
+    }
+
     int JobContainer::stationCount() const
     {
         return m_stationCount;
@@ -361,10 +507,25 @@ namespace fjss {
         int duration = operation.getProcessTimeOnStationID(stationID);
         ScheduledOperation sop(jobID, job.jobTypeID, operationID, operation.operationTypeID, stationID, startTime, duration);
         m_schedule[stationID].push_back(sop);
-        job.dumpOperation(operationID, sop.endTime());
+        m_stackOrder.push_back(stationID);
+        jobContainer.dumpOperation(jobID, operationID, sop.endTime());
         return sop;
     }
 
+    void Schedule::unstackScheduleOperation(JobContainer& jobContainer) {
+        if (m_stackOrder.empty()) {
+            throw std::runtime_error("Nothing to unstack");
+        }
+        std::vector<ScheduledOperation>& station = m_schedule[m_stackOrder.back()];
+        jobContainer.undoOperation(station.back().jobID, station.back().operationID);
+        station.pop_back();
+        m_stackOrder.pop_back();
+    }
+
+    void Schedule::unstackTo(size_t scheduledCount, JobContainer& jobContainer) {
+        while (m_stackOrder.size() > scheduledCount) unstackScheduleOperation(jobContainer);
+    }
+
     int Schedule::getStationAvabilityTime(StationID stationID) const {
         if (stationID >= m_schedule.size()) {
             throw std::runtime_error("No such station");
@@ -401,6 +562,7 @@ namespace fjss {
         for (std::vector<ScheduledOperation>& machineVec : m_schedule) {
             machineVec.clear();
         }
+        m_stackOrder.clear();
     }
 
     std::vector<std::vector<ScheduledOperation>>& Schedule::getSchedule()
@@ -7,6 +7,7 @@
 #include <string>
 #include <algorithm>
 #include <limits>
+#include <cstdint>
 
 template <typename T>
 void printContainer(const T& ctr) {
@@ -31,7 +32,7 @@ namespace fjss {
         std::vector<OperationTimeStation> m_operationTimeStations;
         std::vector<OperationID> m_predecessors;
 
-        std::set<OperationID> m_predecessorsToDo;
+        int m_predecessorsToDo;
         int m_lastPrecedessorTime;
         bool m_done;
 
@@ -44,10 +45,12 @@ namespace fjss {
         void addPredecessor(OperationID operationID);
         void restartOperation();
         bool isAvailible() const;
-        void precedessordoneUpdate(OperationID predecessorID, int endTime);
+        void precedessordoneUpdate(int endTime);
+        void precedessorUndoUpdate(int previousLastPrecedessorTime);
         int getLastPrecedessorTime() const;
         int getProcessTimeOnStationID(StationID stationID) const;
         void markDone();
+        void markUndone();
         bool isDone() const;
         float averageProcessTime() const;
         int getShortestProcessTime() const;
@@ -64,6 +67,15 @@ namespace fjss {
         std::map<OperationID, Operation> m_operations;
         std::vector<OperationID> m_availibleOperations;
         std::map<OperationID, std::vector<OperationID>> m_successors;
+        int m_remainingOperations;
+        uint64_t m_version;
+        // per operation values that only depend on the job's structure, filled by restartJob
+        std::map<OperationID, float> m_criticalPaths;
+        std::map<OperationID, float> m_timeBlocked;
+        bool m_structureCached = false;
+
+        float cacheCriticalPath(OperationID operationID);
+        float cacheTimeBlocked(OperationID operationID);
 
     public:
         JobID jobID;
@@ -73,7 +85,10 @@ namespace fjss {
         void restartJob();
         void addOperation(const Operation& operation);
         void addOperations(const std::vector<Operation> operations);
-        bool dumpOperation(OperationID operationID, int endTime);
+        // availiblePos / previousSuccessorTimes (when given) receive what undoOperation needs
+        bool dumpOperation(OperationID operationID, int endTime, size_t* availiblePos = nullptr, std::vector<int>* previousSuccessorTimes = nullptr);
+        // reverts the last dumpOperation of this job
+        void undoOperation(OperationID operationID, size_t availiblePos, const int* previousSuccessorTimes);
         const Operation& getOperation(OperationID operationID) const;
         bool isDone() const;
         const std::vector<OperationID>& getAvailibleOperations() const { return m_availibleOperations; }
@@ -91,6 +106,8 @@ namespace fjss {
 
         int getSuccessorsUpstream(OperationID operation) const;
         int remainingNumOfOperations() const;
+        // bumped by every dump, undo and restart
+        uint64_t version() const { return m_version; }
     };
 
     /* Job container class ==================================== */
@@ -98,7 +115,33 @@ namespace fjss {
         std::map<JobID, Job> m_jobs;
         int m_stationCount;
 
+        // demand tracker: count of not done operations eligible for each station
+        std::vector<int> m_stationDemand;
+        int m_remainingOperations;
+        int m_remainingShortestWork;
+
+        // a copy gets a fresh stamp, so a container assigned over another at the same address
+        // doesn't look like the state a cache was built from
+        struct Stamp {
+            uint64_t value = 0;
+            Stamp() = default;
+            Stamp(const Stamp& other);
+            Stamp& operator=(const Stamp& other);
+        };
+        Stamp m_restartStamp;
+
+        // undo trail: one entry per dumped operation, cleared by restartContainer
+        struct UndoEntry {
+            JobID jobID;
+            OperationID operationID;
+            size_t availiblePos;
+            size_t successorTimesBegin;
+        };
+        std::vector<UndoEntry> m_undoTrail;
+        std::vector<int> m_undoSuccessorTimes;
+
     public:
+        JobContainer();
         void addJob(const Job& job);
         void addJobs(const std::vector<Job>& jobs);
         bool isDone() const;
@@ -107,8 +150,20 @@ namespace fjss {
         std::map<JobID, Job>& getJobs() { return m_jobs; }
         const std::map<JobID, Job>& getJobs() const { return m_jobs; }
         void restartContainer();
+        bool dumpOperation(JobID jobID, OperationID operationID, int endTime);
+        // reverts the most recent dumpOperation, which must be of this operation
+        void undoOperation(JobID jobID, OperationID operationID);
+        size_t dumpedCount() const { return m_undoTrail.size(); }
         int stationCount() const;
         void setStationCount(int stationCount);
+
+        int getStationDemand(StationID stationID) const { return m_stationDemand[stationID]; }
+        const std::vector<int>& getStationDemands() const { return m_stationDemand; }
+        int remainingOperationCount() const { return m_remainingOperations; }
+        // sum of shortest process times of not done operations
+        int remainingShortestWork() const { return m_remainingShortestWork; }
+        // unique per restartContainer call and per copy, lets caches detect a fresh problem state
+        uint64_t restartStamp() const { return m_restartStamp.value; }
     };
 
     /* ScheduledOperation class ==================================== */
@@ -136,17 +191,25 @@ namespace fjss {
     /* Schedule class ==================================== */
     class Schedule {
         std::vector<std::vector<ScheduledOperation>> m_schedule; // stationID, operationScheduled
+        std::vector<StationID> m_stackOrder; // station of every stacked operation, in stacking order
 
     public:
         Schedule(size_t stationsCount);
         int fastestTimeForScheduleOperation(StationID stationID, OperationID operationID, JobID jobID, const JobContainer& jobContainer) const;
         int fastestEndTimeForScheduleOperation(StationID stationID, OperationID operationID, JobID jobID, const JobContainer& jobContainer) const;
         ScheduledOperation stackScheduleOperation(StationID stationID, OperationID operationID, JobID jobID, JobContainer& jobContainer);
+        // removes the last stacked operation and reverts it in the job container
+        void unstackScheduleOperation(JobContainer& jobContainer);
+        // unstacks until only the first scheduledCount operations are left
+        void unstackTo(size_t scheduledCount, JobContainer& jobContainer);
+        size_t scheduledCount() const { return m_stackOrder.size(); }
+        const std::vector<StationID>& getStackOrder() const { return m_stackOrder; }
         int getStationAvabilityTime(StationID stationID) const;
         void print() const;
         int makeSpan() const;
         void clear();
         std::vector<std::vector<ScheduledOperation>>& getSchedule();
+        const std::vector<std::vector<ScheduledOperation>>& getSchedule() const { return m_schedule; }
         int stationCount() const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "FeatureExtractor.h"
+#include "json.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace ConstructionAlgorithm {
+	const std::array<std::string, InstanceFeatures::Count>& InstanceFeatures::names()
+	{
+		static const std::array<std::string, Count> featureNames = {
+			"jobs", "stations", "operations", "operationsPerJob", "maxOperationsPerJob",
+			"alternativesMean", "alternativesVariance", "flexibility",
+			"meanTime", "timeVariance", "timeCV", "minTime", "maxTime",
+			"timeSpread",
+			"precedenceDensity",
+			"depthMean", "depthMax",
+			"widthMean", "widthMax",
+			"stationDemandMean", "stationDemandCV",
+			"loadImbalance",
+			"dedicatedLoadMax",
+			"loadBound",
+			"pathBound",
+			"lowerBound",
+			"boundRatio"
+		};
+		return featureNames;
+	}
+
+	// ------------------------------ FeatureExtractor
+
+	void FeatureExtractor::beginProblem(int stationCount)
+	{
+		*this = FeatureExtractor();
+		m_stationCount = std::max(stationCount, 1);
+		m_load.assign(m_stationCount, 0.0);
+		m_dedicatedLoad.assign(m_stationCount, 0.0);
+		m_demand.assign(m_stationCount, 0.0);
+	}
+
+	void FeatureExtractor::beginJob()
+	{
+		if (m_inJob) endJob();
+		m_inJob = true;
+		m_jobOperations = 0;
+		m_level.clear();
+		m_tail.clear();
+		m_levelWidth.clear();
+	}
+
+	void FeatureExtractor::addOperation(OperationID operationID, const OperationTimeStation* alternatives, size_t alternativeCount,
+		const OperationID* predecessors, size_t predecessorCount)
+	{
+		if (!m_inJob) beginJob();
+		if (alternativeCount == 0) return;
+
+		int shortest = std::numeric_limits<int>::max();
+		int longest = 0;
+		double timeSum = 0;
+		for (size_t i = 0; i < alternativeCount; ++i) {
+			int time = alternatives[i].time;
+			shortest = std::min(shortest, time);
+			longest = std::max(longest, time);
+			timeSum += time;
+			m_timeSquareSum += (double)time * time;
+			if (m_operations == 0 && i == 0) m_timeMin = m_timeMax = time;
+			m_timeMin = std::min(m_timeMin, (double)time);
+			m_timeMax = std::max(m_timeMax, (double)time);
+		}
+		m_timeSum += timeSum;
+		m_operations += 1;
+		m_jobOperations += 1;
+		m_alternatives += alternativeCount;
+		m_alternativeSquares += (double)alternativeCount * alternativeCount;
+		m_arcs += predecessorCount;
+		m_spread += longest > 0 ? (longest - shortest) / (double)longest : 0;
+		m_shortestWork += shortest;
+
+		// stations past the declared count still count, the vectors just grow
+		double share = timeSum / alternativeCount / alternativeCount;
+		for (size_t i = 0; i < alternativeCount; ++i) {
+			StationID stationID = alternatives[i].stationID;
+			if (stationID >= m_load.size()) {
+				m_load.resize(stationID + 1, 0.0);
+				m_dedicatedLoad.resize(stationID + 1, 0.0);
+				m_demand.resize(stationID + 1, 0.0);
+			}
+			m_load[stationID] += share;
+			m_demand[stationID] += 1;
+			if (alternativeCount == 1) m_dedicatedLoad[stationID] += alternatives[i].time;
+		}
+
+		int level = 0;
+		int head = 0;
+		for (size_t i = 0; i < predecessorCount; ++i) {
+			OperationID predecessorID = predecessors[i];
+			if (predecessorID >= m_level.size() || m_level[predecessorID] < 0) continue;
+			level = std::max(level, m_level[predecessorID]);
+			head = std::max(head, m_tail[predecessorID]);
+		}
+		if (operationID >= m_level.size()) {
+			m_level.resize(operationID + 1, -1);
+			m_tail.resize(operationID + 1, 0);
+		}
+		m_level[operationID] = level + 1;
+		m_tail[operationID] = head + shortest;
+		m_pathBound = std::max(m_pathBound, head + shortest);
+		if (m_levelWidth.size() <= (size_t)level) m_levelWidth.resize(level + 1, 0);
+		++m_levelWidth[level];
+	}
+
+	void FeatureExtractor::endJob()
+	{
+		m_inJob = false;
+		m_jobs += 1;
+		m_maxJobOperations = std::max(m_maxJobOperations, m_jobOperations);
+		double depth = m_levelWidth.size();
+		double width = m_levelWidth.empty() ? 0 : *std::max_element(m_levelWidth.begin(), m_levelWidth.end());
+		m_depthSum += depth;
+		m_depthMax = std::max(m_depthMax, depth);
+		m_widthSum += width;
+		m_widthMax = std::max(m_widthMax, width);
+	}
+
+	InstanceFeatures FeatureExtractor::finish()
+	{
+		if (m_inJob) endJob();
+		InstanceFeatures features;
+		std::array<double, InstanceFeatures::Count>& f = features.values;
+		double stations = (double)std::max(m_stationCount, size_t(1));
+		double alternativesMean = m_operations > 0 ? m_alternatives / m_operations : 0;
+		double timeMean = m_alternatives > 0 ? m_timeSum / m_alternatives : 0;
+		double timeVariance = m_alternatives > 0 ? std::max(0.0, m_timeSquareSum / m_alternatives - timeMean * timeMean) : 0;
+
+		double loadSum = 0, loadMax = 0, demandSum = 0, demandSquareSum = 0, dedicatedMax = 0;
+		for (size_t stationID = 0; stationID < m_load.size(); ++stationID) {
+			loadSum += m_load[stationID];
+			loadMax = std::max(loadMax, m_load[stationID]);
+			demandSum += m_demand[stationID];
+			demandSquareSum += m_demand[stationID] * m_demand[stationID];
+			dedicatedMax = std::max(dedicatedMax, m_dedicatedLoad[stationID]);
+		}
+		double loadMean = loadSum / stations;
+		double demandMean = demandSum / stations;
+		double demandVariance = std::max(0.0, demandSquareSum / stations - demandMean * demandMean);
+		double loadBound = m_shortestWork / stations;
+
+		f[InstanceFeatures::Jobs] = m_jobs;
+		f[InstanceFeatures::Stations] = stations;
+		f[InstanceFeatures::Operations] = m_operations;
+		f[InstanceFeatures::OperationsPerJob] = m_jobs > 0 ? m_operations / m_jobs : 0;
+		f[InstanceFeatures::MaxOperationsPerJob] = m_maxJobOperations;
+		f[InstanceFeatures::AlternativesMean] = alternativesMean;
+		f[InstanceFeatures::AlternativesVariance] = m_operations > 0 ?
+			std::max(0.0, m_alternativeSquares / m_operations - alternativesMean * alternativesMean) : 0;
+		f[InstanceFeatures::Flexibility] = alternativesMean / stations;
+		f[InstanceFeatures::TimeMean] = timeMean;
+		f[InstanceFeatures::TimeVariance] = timeVariance;
+		f[InstanceFeatures::TimeCV] = timeMean > 0 ? std::sqrt(timeVariance) / timeMean : 0;
+		f[InstanceFeatures::TimeMin] = m_timeMin;
+		f[InstanceFeatures::TimeMax] = m_timeMax;
+		f[InstanceFeatures::TimeSpread] = m_operations > 0 ? m_spread / m_operations : 0;
+		f[InstanceFeatures::PrecedenceDensity] = m_operations > 0 ? m_arcs / m_operations : 0;
+		f[InstanceFeatures::DepthMean] = m_jobs > 0 ? m_depthSum / m_jobs : 0;
+		f[InstanceFeatures::DepthMax] = m_depthMax;
+		f[InstanceFeatures::WidthMean] = m_jobs > 0 ? m_widthSum / m_jobs : 0;
+		f[InstanceFeatures::WidthMax] = m_widthMax;
+		f[InstanceFeatures::StationDemandMean] = demandMean;
+		f[InstanceFeatures::StationDemandCV] = demandMean > 0 ? std::sqrt(demandVariance) / demandMean : 0;
+		f[InstanceFeatures::LoadImbalance] = loadMean > 0 ? loadMax / loadMean : 1;
+		f[InstanceFeatures::DedicatedLoadMax] = dedicatedMax;
+		f[InstanceFeatures::LoadBound] = loadBound;
+		f[InstanceFeatures::PathBound] = m_pathBound;
+		f[InstanceFeatures::LowerBound] = std::max({ std::ceil(loadBound), (double)m_pathBound, dedicatedMax });
+		f[InstanceFeatures::BoundRatio] = loadBound > 0 ? m_pathBound / loadBound : 0;
+		return features;
+	}
+
+	InstanceFeatures FeatureExtractor::extract(const JobContainer& jobContainer)
+	{
+		FeatureExtractor extractor;
+		extractor.beginProblem(jobContainer.stationCount());
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			extractor.beginJob();
+			for (const auto& operationIT : jobIT.second.getOperaions()) {
+				const std::vector<OperationTimeStation>& otss = operationIT.second.getOperationTimeStations();
+				const std::vector<OperationID>& predecessors = operationIT.second.getPredecessors();
+				extractor.addOperation(operationIT.first, otss.data(), otss.size(), predecessors.data(), predecessors.size());
+			}
+		}
+		return extractor.finish();
+	}
+
+	// ------------------------------ Streaming reader
+
+	namespace {
+		/* SAX handler for {"name", "numM", "Jobs": [job][operation][[time, station]], "Prec": [job][operation][predecessor]}.
+		   Jobs and Prec may come in any order, so a problem is buffered as flat arrays and fed to the
+		   extractor when its object closes. */
+		class FeatureSax : public nlohmann::json_sax<nlohmann::json> {
+		public:
+			using Callback = std::function<bool(const std::string& name, const InstanceFeatures& features)>;
+
+			explicit FeatureSax(const Callback& callback) : m_callback(callback) {}
+			size_t problems() const { return m_problems; }
+
+			bool null() override { return true; }
+			bool boolean(bool) override { return true; }
+			bool number_integer(number_integer_t value) override { return number((double)value); }
+			bool number_unsigned(number_unsigned_t value) override { return number((double)value); }
+			bool number_float(number_float_t value, const string_t&) override { return number(value); }
+			bool string(string_t& value) override
+			{
+				if (m_section == Section::Name && m_depth == m_problemDepth) m_name = value;
+				return true;
+			}
+			bool binary(binary_t&) override { return true; }
+
+			bool start_object(std::size_t) override
+			{
+				// a problem is the top level object or an object of the top level array
+				bool problem = m_problemDepth < 0 && (m_depth == 0 || (m_depth == 1 && m_topArray));
+				++m_depth;
+				if (problem) beginProblem();
+				return true;
+			}
+			bool key(string_t& key) override
+			{
+				if (m_depth != m_problemDepth) return true;
+				if (key == "Jobs") m_section = Section::Jobs;
+				else if (key == "Prec") m_section = Section::Prec;
+				else if (key == "numM") m_section = Section::NumM;
+				else if (key == "name") m_section = Section::Name;
+				else m_section = Section::None;
+				return true;
+			}
+			bool end_object() override
+			{
+				bool problem = m_depth == m_problemDepth;
+				--m_depth;
+				if (problem) return endProblem();
+				return true;
+			}
+			bool start_array(std::size_t) override
+			{
+				if (m_depth == 0) m_topArray = true;
+				++m_depth;
+				int relative = m_depth - m_problemDepth;
+				if (m_problemDepth < 0) return true;
+				if (m_section == Section::Jobs) {
+					if (relative == 2) m_jobBegin.push_back(m_operationBegin.size());
+					else if (relative == 3) m_operationBegin.push_back(m_alternatives.size());
+					else if (relative == 4) {
+						m_alternatives.push_back(OperationTimeStation());
+						m_pairIndex = 0;
+					}
+				}
+				else if (m_section == Section::Prec) {
+					if (relative == 2) m_precJobBegin.push_back(m_precOperationBegin.size());
+					else if (relative == 3) m_precOperationBegin.push_back(m_predecessors.size());
+				}
+				return true;
+			}
+			bool end_array() override
+			{
+				--m_depth;
+				return true;
+			}
+			bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override
+			{
+				throw std::runtime_error("streamFeatures: parse error at " + std::to_string(position) + ": " + ex.what());
+			}
+
+		private:
+			enum class Section { None, Jobs, Prec, NumM, Name };
+
+			bool number(double value)
+			{
+				if (m_problemDepth < 0) return true;
+				int relative = m_depth - m_problemDepth;
+				if (m_section == Section::NumM && relative == 0) m_stationCount = (int)value;
+				else if (m_section == Section::Jobs && relative == 4) {
+					if (m_pairIndex == 0) m_alternatives.back().time = (int)value;
+					else if (m_pairIndex == 1) m_alternatives.back().stationID = (StationID)value;
+					++m_pairIndex;
+				}
+				else if (m_section == Section::Prec && relative == 3) m_predecessors.push_back((OperationID)value);
+				return true;
+			}
+
+			void beginProblem()
+			{
+				m_problemDepth = m_depth;
+				m_section = Section::None;
+				m_name.clear();
+				m_stationCount = 0;
+				m_jobBegin.clear();
+				m_operationBegin.clear();
+				m_alternatives.clear();
+				m_precJobBegin.clear();
+				m_precOperationBegin.clear();
+				m_predecessors.clear();
+			}
+
+			bool endProblem()
+			{
+				m_problemDepth = -1;
+				m_section = Section::None;
+				m_extractor.beginProblem(m_stationCount);
+				for (size_t job = 0; job < m_jobBegin.size(); ++job) {
+					m_extractor.beginJob();
+					size_t operationEnd = job + 1 < m_jobBegin.size() ? m_jobBegin[job + 1] : m_operationBegin.size();
+					size_t precBegin = job < m_precJobBegin.size() ? m_precJobBegin[job] : m_precOperationBegin.size();
+					size_t precEnd = job + 1 < m_precJobBegin.size() ? m_precJobBegin[job + 1] : m_precOperationBegin.size();
+					for (size_t operation = m_jobBegin[job]; operation < operationEnd; ++operation) {
+						OperationID operationID = (OperationID)(operation - m_jobBegin[job]);
+						size_t alternativeEnd = operation + 1 < m_operationBegin.size() ? m_operationBegin[operation + 1] : m_alternatives.size();
+						const OperationID* predecessors = nullptr;
+						size_t predecessorCount = 0;
+						size_t precOperation = precBegin + operationID;
+						if (precOperation < precEnd) {
+							size_t predecessorEnd = precOperation + 1 < m_precOperationBegin.size() ? m_precOperationBegin[precOperation + 1] : m_predecessors.size();
+							predecessors = m_predecessors.data() + m_precOperationBegin[precOperation];
+							predecessorCount = predecessorEnd - m_precOperationBegin[precOperation];
+						}
+						m_extractor.addOperation(operationID, m_alternatives.data() + m_operationBegin[operation],
+							alternativeEnd - m_operationBegin[operation], predecessors, predecessorCount);
+					}
+				}
+				++m_problems;
+				return m_callback(m_name, m_extractor.finish());
+			}
+
+			const Callback& m_callback;
+			FeatureExtractor m_extractor;
+			size_t m_problems = 0;
+			int m_depth = 0;
+			int m_problemDepth = -1;
+			bool m_topArray = false;
+			Section m_section = Section::None;
+			int m_pairIndex = 0;
+
+			std::string m_name;
+			int m_stationCount = 0;
+			std::vector<size_t> m_jobBegin;			// -> m_operationBegin
+			std::vector<size_t> m_operationBegin;	// -> m_alternatives
+			std::vector<OperationTimeStation> m_alternatives;
+			std::vector<size_t> m_precJobBegin;		// -> m_precOperationBegin
+			std::vector<size_t> m_precOperationBegin;	// -> m_predecessors
+			std::vector<OperationID> m_predecessors;
+		};
+	}
+
+	size_t streamFeatures(std::istream& is, const std::function<bool(const std::string& name, const InstanceFeatures& features)>& callback)
+	{
+		FeatureSax sax(callback);
+		nlohmann::json::sax_parse(is, &sax);
+		return sax.problems();
+	}
+}
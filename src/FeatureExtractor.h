@@ -0,0 +1,74 @@
+#pragma once
+
+#include "FJSS.hpp"
+#include <array>
+#include <string>
+#include <istream>
+#include <functional>
+
+using namespace fjss;
+
+namespace ConstructionAlgorithm {
+	struct InstanceFeatures {
+		enum Feature : size_t {
+			Jobs, Stations, Operations, OperationsPerJob, MaxOperationsPerJob,
+			AlternativesMean, AlternativesVariance, Flexibility,		// flexibility = alternatives mean / stations
+			TimeMean, TimeVariance, TimeCV, TimeMin, TimeMax,			// over every (operation, station) alternative
+			TimeSpread,				// average (longest - shortest) / longest of an operation
+			PrecedenceDensity,		// precedence arcs per operation
+			DepthMean, DepthMax,	// operations on the longest precedence chain of a job
+			WidthMean, WidthMax,	// most operations of a job on one precedence level
+			StationDemandMean, StationDemandCV,		// operations that may run on a station
+			LoadImbalance,			// max / mean station load, operations split evenly over their alternatives
+			DedicatedLoadMax,		// work of single alternative operations on the busiest station
+			LoadBound,				// shortest work / stations
+			PathBound,				// longest job path on shortest times
+			LowerBound,				// max of the above three, rounded up
+			BoundRatio,				// path bound / load bound
+			Count
+		};
+
+		std::array<double, Count> values{};
+
+		double operator[](Feature feature) const { return values[feature]; }
+		static const std::array<std::string, Count>& names();
+	};
+
+	/* Fixed size features in one linear pass, fed operation by operation so the same code serves
+	   built JobContainers and the streaming file reader. Operations of a job have to come with their
+	   predecessors first, which every loader guarantees (predecessors are numbered lower). */
+	class FeatureExtractor {
+	public:
+		void beginProblem(int stationCount);
+		void beginJob();
+		void addOperation(OperationID operationID, const OperationTimeStation* alternatives, size_t alternativeCount,
+			const OperationID* predecessors, size_t predecessorCount);
+		InstanceFeatures finish();
+
+		static InstanceFeatures extract(const JobContainer& jobContainer);
+
+	private:
+		void endJob();
+
+		size_t m_stationCount = 0;
+		double m_jobs = 0, m_operations = 0, m_maxJobOperations = 0;
+		double m_alternatives = 0, m_alternativeSquares = 0, m_arcs = 0, m_spread = 0;
+		double m_timeSum = 0, m_timeSquareSum = 0, m_timeMin = 0, m_timeMax = 0;
+		double m_shortestWork = 0;
+		double m_depthSum = 0, m_depthMax = 0, m_widthSum = 0, m_widthMax = 0;
+		int m_pathBound = 0;
+		std::vector<double> m_load, m_dedicatedLoad, m_demand;
+
+		// current job, indexed by OperationID, -1 for not seen
+		bool m_inJob = false;
+		double m_jobOperations = 0;
+		std::vector<int> m_level, m_tail;
+		std::vector<int> m_levelWidth;
+	};
+
+	/* Streams a problem file (one problem object or an array of them, the format parseProblem reads)
+	   through the SAX parser without building json or JobContainer objects. callback gets the problem
+	   name (empty if there is none) and its features, returning false stops the read.
+	   Returns the number of problems handed to callback; malformed input throws std::runtime_error. */
+	size_t streamFeatures(std::istream& is, const std::function<bool(const std::string& name, const InstanceFeatures& features)>& callback);
+}
@@ -0,0 +1,460 @@
+#include "Genetic.h"
+#include "Parallel.hpp"
+#include <numeric>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		/* Instance as flat arrays, operations are nodes numbered job by job */
+		struct GeneticInstance {
+			std::vector<JobID> jobID;
+			std::vector<OperationID> operationID;
+			std::vector<int> job;						// dense job index of every node
+			std::vector<size_t> predecessorBegin, successorBegin, alternativeBegin;
+			std::vector<int> predecessors, successors;
+			std::vector<StationID> stations;
+			std::vector<int> times;
+			std::vector<std::vector<int>> nodeIndex;	// [jobID][operationID]
+			std::vector<std::vector<int>> jobNodes;		// per dense job, its nodes in a topological order
+			size_t stationCount = 0;
+
+			size_t nodeCount() const { return jobID.size(); }
+		};
+
+		GeneticInstance flatten(const JobContainer& instance)
+		{
+			GeneticInstance flat;
+			flat.stationCount = instance.stationCount();
+			for (const auto& jobIT : instance.getJobs()) {
+				const Job& job = jobIT.second;
+				if (flat.nodeIndex.size() <= jobIT.first) flat.nodeIndex.resize(jobIT.first + 1);
+				OperationID lastID = job.getOperaions().empty() ? 0 : job.getOperaions().rbegin()->first;
+				flat.nodeIndex[jobIT.first].assign(lastID + 1, -1);
+				for (const auto& operationIT : job.getOperaions()) {
+					flat.nodeIndex[jobIT.first][operationIT.first] = (int)flat.jobID.size();
+					flat.jobID.push_back(jobIT.first);
+					flat.operationID.push_back(operationIT.first);
+					flat.job.push_back((int)flat.jobNodes.size());
+				}
+				flat.jobNodes.emplace_back();
+			}
+
+			flat.predecessorBegin.push_back(0);
+			flat.successorBegin.push_back(0);
+			flat.alternativeBegin.push_back(0);
+			for (size_t node = 0; node < flat.nodeCount(); ++node) {
+				const Job& job = instance.getJob(flat.jobID[node]);
+				const Operation& operation = job.getOperation(flat.operationID[node]);
+				const std::vector<int>& jobIndex = flat.nodeIndex[flat.jobID[node]];
+				for (OperationID predecessorID : operation.getPredecessors()) flat.predecessors.push_back(jobIndex[predecessorID]);
+				for (OperationID successorID : job.getSuccessors(flat.operationID[node])) flat.successors.push_back(jobIndex[successorID]);
+				for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+					flat.stations.push_back(ots.stationID);
+					// a station listed twice runs at its first time, as in Schedule
+					flat.times.push_back(operation.getProcessTimeOnStationID(ots.stationID));
+				}
+				flat.predecessorBegin.push_back(flat.predecessors.size());
+				flat.successorBegin.push_back(flat.successors.size());
+				flat.alternativeBegin.push_back(flat.stations.size());
+			}
+
+			// Kahn inside every job, lowest node first
+			std::vector<int> waiting(flat.nodeCount());
+			for (size_t node = 0; node < flat.nodeCount(); ++node) {
+				waiting[node] = (int)(flat.predecessorBegin[node + 1] - flat.predecessorBegin[node]);
+			}
+			for (size_t node = 0; node < flat.nodeCount(); ++node) {
+				if (waiting[node] == 0) flat.jobNodes[flat.job[node]].push_back((int)node);
+			}
+			for (std::vector<int>& nodes : flat.jobNodes) {
+				for (size_t i = 0; i < nodes.size(); ++i) {
+					int node = nodes[i];
+					for (size_t s = flat.successorBegin[node]; s < flat.successorBegin[node + 1]; ++s) {
+						if (--waiting[flat.successors[s]] == 0) nodes.push_back(flat.successors[s]);
+					}
+				}
+			}
+			return flat;
+		}
+
+		/* per worker buffers */
+		struct GeneticScratch {
+			std::vector<int> stationReady, end, position, buffer;
+			std::vector<char> jobMask;
+		};
+
+		/* makespan of the semi-active schedule: every operation appended to its station in sequence order */
+		int decode(const GeneticInstance& flat, const int* sequence, const int* selection, GeneticScratch& scratch)
+		{
+			scratch.stationReady.assign(flat.stationCount, 0);
+			scratch.end.resize(flat.nodeCount());
+			int makeSpan = 0;
+			for (size_t p = 0; p < flat.nodeCount(); ++p) {
+				int node = sequence[p];
+				size_t alternative = flat.alternativeBegin[node] + selection[node];
+				StationID stationID = flat.stations[alternative];
+				int start = scratch.stationReady[stationID];
+				for (size_t i = flat.predecessorBegin[node]; i < flat.predecessorBegin[node + 1]; ++i) {
+					start = std::max(start, scratch.end[flat.predecessors[i]]);
+				}
+				int end = start + flat.times[alternative];
+				scratch.end[node] = end;
+				scratch.stationReady[stationID] = end;
+				makeSpan = std::max(makeSpan, end);
+			}
+			return makeSpan;
+		}
+
+		/* job repetition order: a shuffled multiset of jobs, the k-th copy of a job takes its k-th node */
+		void randomChromosome(const GeneticInstance& flat, int* sequence, int* selection, Xoshiro256& rng, GeneticScratch& scratch)
+		{
+			scratch.buffer.clear();
+			for (size_t job = 0; job < flat.jobNodes.size(); ++job) {
+				scratch.buffer.insert(scratch.buffer.end(), flat.jobNodes[job].size(), (int)job);
+			}
+			for (size_t i = scratch.buffer.size(); i > 1; --i) std::swap(scratch.buffer[i - 1], scratch.buffer[rng.uniformInt((uint32_t)i)]);
+			scratch.position.assign(flat.jobNodes.size(), 0);
+			for (size_t p = 0; p < scratch.buffer.size(); ++p) {
+				int job = scratch.buffer[p];
+				sequence[p] = flat.jobNodes[job][scratch.position[job]++];
+			}
+			for (size_t node = 0; node < flat.nodeCount(); ++node) {
+				selection[node] = (int)rng.uniformInt((uint32_t)(flat.alternativeBegin[node + 1] - flat.alternativeBegin[node]));
+			}
+		}
+
+		/* POX on the sequence, uniform crossover on the selection */
+		void crossover(const GeneticInstance& flat, const int* first, const int* second, int* child, Xoshiro256& rng, GeneticScratch& scratch)
+		{
+			size_t nodeCount = flat.nodeCount();
+			scratch.jobMask.resize(flat.jobNodes.size());
+			for (size_t job = 0; job < scratch.jobMask.size(); ++job) scratch.jobMask[job] = (char)(rng() >> 63);
+			size_t from = 0;
+			for (size_t p = 0; p < nodeCount; ++p) {
+				if (scratch.jobMask[flat.job[first[p]]]) {
+					child[p] = first[p];
+					continue;
+				}
+				while (scratch.jobMask[flat.job[second[from]]]) ++from;
+				child[p] = second[from++];
+			}
+
+			const int* firstSelection = first + nodeCount;
+			const int* secondSelection = second + nodeCount;
+			int* childSelection = child + nodeCount;
+			uint64_t bits = 0;
+			for (size_t node = 0; node < nodeCount; ++node) {
+				if (node % 64 == 0) bits = rng();
+				childSelection[node] = (bits & 1) ? firstSelection[node] : secondSelection[node];
+				bits >>= 1;
+			}
+		}
+
+		/* one node to a random place between its last job predecessor and first job successor */
+		void moveMutation(const GeneticInstance& flat, int* sequence, Xoshiro256& rng, GeneticScratch& scratch)
+		{
+			size_t nodeCount = flat.nodeCount();
+			scratch.position.resize(nodeCount);
+			for (size_t p = 0; p < nodeCount; ++p) scratch.position[sequence[p]] = (int)p;
+			size_t from = rng.uniformInt((uint32_t)nodeCount);
+			int node = sequence[from];
+			size_t low = 0;
+			size_t high = nodeCount - 1;
+			for (size_t i = flat.predecessorBegin[node]; i < flat.predecessorBegin[node + 1]; ++i) {
+				low = std::max(low, (size_t)scratch.position[flat.predecessors[i]] + 1);
+			}
+			for (size_t i = flat.successorBegin[node]; i < flat.successorBegin[node + 1]; ++i) {
+				high = std::min(high, (size_t)scratch.position[flat.successors[i]] - 1);
+			}
+			size_t to = low + rng.uniformInt((uint32_t)(high - low + 1));
+			if (to < from) std::rotate(sequence + to, sequence + from, sequence + from + 1);
+			else if (to > from) std::rotate(sequence + from, sequence + from + 1, sequence + to + 1);
+		}
+
+		void reassignMutation(const GeneticInstance& flat, int* selection, Xoshiro256& rng)
+		{
+			size_t node = rng.uniformInt((uint32_t)flat.nodeCount());
+			uint32_t count = (uint32_t)(flat.alternativeBegin[node + 1] - flat.alternativeBegin[node]);
+			if (count > 1) selection[node] = (int)((selection[node] + 1 + rng.uniformInt(count - 1)) % count);
+		}
+
+		/* the planner's stacking order is a feasible sequence already */
+		void scheduleChromosome(const GeneticInstance& flat, const Schedule& schedule, int* sequence, int* selection,
+			std::vector<ScheduleDecision>& decisions)
+		{
+			stackedDecisions(schedule, decisions);
+			for (size_t p = 0; p < decisions.size(); ++p) {
+				const ScheduleDecision& decision = decisions[p];
+				int node = flat.nodeIndex[decision.jobID][decision.operationID];
+				sequence[p] = node;
+				size_t alternative = flat.alternativeBegin[node];
+				while (flat.stations[alternative] != decision.stationID) ++alternative;
+				selection[node] = (int)(alternative - flat.alternativeBegin[node]);
+			}
+		}
+
+		struct SeedWorker {
+			JobContainer jobContainer;
+			Schedule schedule = Schedule(0);
+			std::vector<ScheduleDecision> decisions;
+		};
+	}
+
+	struct GeneticSearch::State {
+		const JobContainer& instance;
+		GeneticOptions options;
+		GeneticInstance flat;
+		size_t nodeCount;
+		size_t populationSize;
+		size_t eliteCount;
+		size_t stride;		// sequence, then selection
+		Parallel::WorkerPool pool;
+		std::vector<GeneticScratch> scratch;
+		// both generations in one block, no allocation once the loop runs
+		std::vector<int> arena;
+		std::vector<int> fitness[2];
+		std::vector<int> best;
+		std::vector<size_t> order;
+		std::vector<ScheduleDecision> decisions;
+		GeneticResult result;		// bestSchedule is only built on request
+		size_t current = 0;
+		size_t sinceImprovement = 0;
+
+		State(const JobContainer& instance, const GeneticOptions& options)
+			: instance(instance), options(options), flat(flatten(instance)), pool(options.threadCount)
+		{
+			nodeCount = flat.nodeCount();
+			populationSize = std::max<size_t>(options.populationSize, 1);
+			eliteCount = std::min(options.eliteCount, populationSize - 1);
+			stride = 2 * nodeCount;
+			scratch.resize(pool.workerCount());
+			arena.assign(2 * populationSize * stride, 0);
+			fitness[0].assign(populationSize, 0);
+			fitness[1].assign(populationSize, 0);
+			best.assign(stride, 0);
+			order.resize(populationSize);
+		}
+
+		int* chromosome(size_t generation, size_t index) { return arena.data() + (generation * populationSize + index) * stride; }
+		const int* chromosome(size_t generation, size_t index) const { return arena.data() + (generation * populationSize + index) * stride; }
+
+		bool running() const
+		{
+			return nodeCount > 0 && result.generations < options.generations && sinceImprovement < options.maxNoImprove;
+		}
+
+		bool keepBest()
+		{
+			const std::vector<int>& values = fitness[current];
+			size_t index = std::min_element(values.begin(), values.end()) - values.begin();
+			if (values[index] >= result.bestMakeSpan) return false;
+			result.bestMakeSpan = values[index];
+			std::copy(chromosome(current, index), chromosome(current, index) + stride, best.begin());
+			return true;
+		}
+
+		/* the decoder is Schedule's own stacking rule, replaying the sequence gives the same makespan */
+		Schedule toSchedule(const int* genes) const
+		{
+			JobContainer jobContainer = instance;
+			jobContainer.restartContainer();
+			Schedule schedule(instance.stationCount());
+			for (size_t p = 0; p < nodeCount; ++p) {
+				int node = genes[p];
+				StationID stationID = flat.stations[flat.alternativeBegin[node] + genes[nodeCount + node]];
+				schedule.stackScheduleOperation(stationID, flat.operationID[node], flat.jobID[node], jobContainer);
+			}
+			return schedule;
+		}
+
+		void initialize();
+		void step();
+	};
+
+	void GeneticSearch::State::initialize()
+	{
+		PlannerConfig callerSettings = threadSettings();
+		std::vector<PlannerConfig> seeds = options.seeds;
+		if (seeds.empty()) {
+			PlannerConfig config = callerSettings;
+			config.name = "CP_HF_Planner";
+			config.planner = CP_HF_Planner;
+			seeds.push_back(config);
+			config.name = "HF2_Planner";
+			config.planner = HF2_Planner;
+			seeds.push_back(config);
+			for (const PlannerConfig& dispatch : dispatchConfigs()) seeds.push_back(dispatch);
+		}
+
+		// planner seeds, then mutated copies of them and random individuals
+		size_t seedCount = std::min(seeds.size(), populationSize);
+		std::vector<std::unique_ptr<SeedWorker>> seedWorkers(pool.workerCount());
+		pool.parallelFor(seedCount, [&](size_t index, unsigned workerIndex) {
+			std::unique_ptr<SeedWorker>& worker = seedWorkers[workerIndex];
+			if (!worker) {
+				worker.reset(new SeedWorker());
+				worker->jobContainer = instance;
+				worker->schedule = Schedule(instance.stationCount());
+			}
+			seeds[index].apply();
+			worker->jobContainer.restartContainer();
+			worker->schedule.clear();
+			ConstructionSolver solver(worker->jobContainer, worker->schedule, seeds[index].planner);
+			solver.scheduleAll();
+			int* genes = chromosome(0, index);
+			scheduleChromosome(flat, worker->schedule, genes, genes + nodeCount, worker->decisions);
+			fitness[0][index] = decode(flat, genes, genes + nodeCount, scratch[workerIndex]);
+		});
+		callerSettings.apply();
+
+		pool.parallelFor(populationSize - seedCount, [&](size_t offset, unsigned workerIndex) {
+			size_t index = seedCount + offset;
+			Xoshiro256 rng = Xoshiro256::taskStream(options.seed, index);
+			int* genes = chromosome(0, index);
+			if (seedCount > 0 && index % 2 == 1) {
+				std::copy(chromosome(0, index % seedCount), chromosome(0, index % seedCount) + stride, genes);
+				for (size_t move = 0; move < nodeCount / 10 + 1; ++move) {
+					moveMutation(flat, genes, rng, scratch[workerIndex]);
+					reassignMutation(flat, genes + nodeCount, rng);
+				}
+			}
+			else {
+				randomChromosome(flat, genes, genes + nodeCount, rng, scratch[workerIndex]);
+			}
+			fitness[0][index] = decode(flat, genes, genes + nodeCount, scratch[workerIndex]);
+		});
+		result.evaluations = populationSize;
+		keepBest();
+	}
+
+	void GeneticSearch::State::step()
+	{
+		size_t generation = result.generations + 1;
+		size_t next = 1 - current;
+		const std::vector<int>& parentFitness = fitness[current];
+		std::iota(order.begin(), order.end(), 0);
+		std::partial_sort(order.begin(), order.begin() + eliteCount, order.end(), [&](size_t a, size_t b) {
+			return parentFitness[a] < parentFitness[b] || (parentFitness[a] == parentFitness[b] && a < b);
+		});
+		for (size_t e = 0; e < eliteCount; ++e) {
+			std::copy(chromosome(current, order[e]), chromosome(current, order[e]) + stride, chromosome(next, e));
+			fitness[next][e] = parentFitness[order[e]];
+		}
+
+		auto tournament = [&](Xoshiro256& rng) {
+			size_t winner = rng.uniformInt((uint32_t)populationSize);
+			for (size_t round = 1; round < options.tournamentSize; ++round) {
+				size_t challenger = rng.uniformInt((uint32_t)populationSize);
+				if (parentFitness[challenger] < parentFitness[winner] ||
+					(parentFitness[challenger] == parentFitness[winner] && challenger < winner)) winner = challenger;
+			}
+			return winner;
+		};
+
+		pool.parallelFor(populationSize - eliteCount, [&](size_t offset, unsigned workerIndex) {
+			size_t index = eliteCount + offset;
+			Xoshiro256 rng = Xoshiro256::taskStream(options.seed, generation * populationSize + index);
+			const int* first = chromosome(current, tournament(rng));
+			const int* second = chromosome(current, tournament(rng));
+			int* child = chromosome(next, index);
+			if (rng.uniformReal() < options.crossoverRate) crossover(flat, first, second, child, rng, scratch[workerIndex]);
+			else std::copy(first, first + stride, child);
+			if (rng.uniformReal() < options.mutationRate) moveMutation(flat, child, rng, scratch[workerIndex]);
+			if (rng.uniformReal() < options.mutationRate) reassignMutation(flat, child + nodeCount, rng);
+			fitness[next][index] = decode(flat, child, child + nodeCount, scratch[workerIndex]);
+		});
+		result.evaluations += populationSize - eliteCount;
+		result.generations = generation;
+		current = next;
+
+		if (keepBest()) {
+			++result.improvements;
+			sinceImprovement = 0;
+		}
+		else {
+			++sinceImprovement;
+		}
+	}
+
+	GeneticSearch::GeneticSearch(const JobContainer& instance, const GeneticOptions& options)
+		: m_state(new State(instance, options))
+	{
+		if (m_state->nodeCount == 0) m_state->result.bestMakeSpan = 0;
+		else m_state->initialize();
+	}
+
+	GeneticSearch::~GeneticSearch() = default;
+
+	bool GeneticSearch::run(size_t generations)
+	{
+		State& state = *m_state;
+		for (size_t i = 0; i < generations && state.running(); ++i) state.step();
+		return state.running();
+	}
+
+	int GeneticSearch::bestMakeSpan() const
+	{
+		return m_state->result.bestMakeSpan;
+	}
+
+	Schedule GeneticSearch::bestSchedule() const
+	{
+		return m_state->toSchedule(m_state->best.data());
+	}
+
+	std::vector<Schedule> GeneticSearch::population(size_t count) const
+	{
+		const State& state = *m_state;
+		const std::vector<int>& values = state.fitness[state.current];
+		std::vector<size_t> order(state.populationSize);
+		for (size_t index = 0; index < order.size(); ++index) order[index] = index;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+
+		std::vector<const int*> kept;
+		for (size_t index : order) {
+			if (kept.size() >= count) break;
+			const int* genes = state.chromosome(state.current, index);
+			bool clone = false;
+			for (const int* other : kept) {
+				if (std::equal(genes, genes + state.stride, other)) {
+					clone = true;
+					break;
+				}
+			}
+			if (!clone) kept.push_back(genes);
+		}
+		std::vector<Schedule> schedules;
+		for (const int* genes : kept) schedules.push_back(state.toSchedule(genes));
+		return schedules;
+	}
+
+	void GeneticSearch::immigrate(const Schedule& schedule)
+	{
+		// replaces the worst individual
+		State& state = *m_state;
+		if (state.nodeCount == 0) return;
+		std::vector<int>& values = state.fitness[state.current];
+		size_t worst = std::max_element(values.begin(), values.end()) - values.begin();
+		int* genes = state.chromosome(state.current, worst);
+		scheduleChromosome(state.flat, schedule, genes, genes + state.nodeCount, state.decisions);
+		values[worst] = decode(state.flat, genes, genes + state.nodeCount, state.scratch[0]);
+		++state.result.evaluations;
+		if (state.keepBest()) {
+			++state.result.improvements;
+			state.sinceImprovement = 0;
+		}
+	}
+
+	GeneticResult GeneticSearch::result() const
+	{
+		GeneticResult result = m_state->result;
+		result.bestSchedule = bestSchedule();
+		return result;
+	}
+
+	GeneticResult geneticAlgorithm(const JobContainer& instance, const GeneticOptions& options)
+	{
+		GeneticSearch search(instance, options);
+		search.run(options.generations);
+		return search.result();
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Portfolio.h"
+#include "ImprovementSearch.h"
+#include <memory>
+
+namespace ConstructionAlgorithm {
+	struct GeneticOptions {
+		/* planners whose schedules seed the population, empty -> CP_HF and HF2 with the calling thread's
+		   params plus every dispatchConfigs() pair */
+		std::vector<PlannerConfig> seeds;
+		size_t populationSize = 200;
+		size_t generations = 500;
+		size_t maxNoImprove = 100;		// stop after this many generations without a new best
+		size_t eliteCount = 2;			// best individuals copied into the next generation unchanged
+		size_t tournamentSize = 2;
+		double crossoverRate = 0.9;
+		double mutationRate = 0.3;		// chance per child of one sequence move and, separately, one reassignment
+		unsigned threadCount = 0;		// 0 -> hardware concurrency
+		uint64_t seed = 1;
+	};
+
+	struct GeneticResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t generations = 0;
+		size_t evaluations = 0;
+		size_t improvements = 0;
+	};
+
+	/* Genetic algorithm on the operation sequence / machine selection encoding. The OS part lists the
+	   operations in a precedence feasible order (job repetition, generalised to jobs whose operations form
+	   a DAG), the MS part holds an alternative index per operation. Decoding appends every operation to its
+	   station's tail like Schedule does, so a seed decodes to exactly the schedule its planner built.
+	   Crossover is POX on the sequence (a random job subset keeps its places from the first parent, the
+	   rest follows the second) and uniform on the selection; mutations move one operation inside its
+	   precedence window or give it another station.
+	   All chromosomes live in one arena allocated up front. Children are built and evaluated in parallel
+	   on a Parallel::WorkerPool, child i of generation g draws from taskStream(seed, g * populationSize + i),
+	   so results don't depend on the thread count. */
+	class GeneticSearch : public ImprovementSearch {
+	public:
+		/* seeds the population; the instance is kept by reference and must outlive the search */
+		GeneticSearch(const JobContainer& instance, const GeneticOptions& options = GeneticOptions());
+		~GeneticSearch() override;
+
+		/* generations, options.generations and maxNoImprove count over all runs */
+		bool run(size_t generations) override;
+		int bestMakeSpan() const override;
+		Schedule bestSchedule() const override;
+		/* the schedule replaces the worst individual */
+		void immigrate(const Schedule& schedule) override;
+		/* the count best distinct chromosomes of the current generation as schedules, best first,
+		   e.g. to seed pathRelinking */
+		std::vector<Schedule> population(size_t count) const;
+
+		GeneticResult result() const;
+
+	private:
+		struct State;
+		std::unique_ptr<State> m_state;
+	};
+
+	/* GeneticSearch run until it stops */
+	GeneticResult geneticAlgorithm(const JobContainer& instance, const GeneticOptions& options = GeneticOptions());
+}
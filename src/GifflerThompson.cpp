@@ -0,0 +1,158 @@
+#include "GifflerThompson.h"
+
+namespace ConstructionAlgorithm {
+	GifflerThompson::GifflerThompson(const CandidateScorer& priority)
+		:m_priority(priority)
+	{
+		m_jobContainer = nullptr;
+		m_restartStamp = 0;
+	}
+
+	ScheduleDecision GifflerThompson::operator()(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		sync(jobContainer, schedule);
+
+		// earliest completion time C* and its station m*
+		StationID station = 0;
+		int bestCompletion = std::numeric_limits<int>::max();
+		for (StationID stationID = 0; stationID < m_stationBest.size(); ++stationID) {
+			if (m_stationBest[stationID] < bestCompletion) {
+				bestCompletion = m_stationBest[stationID];
+				station = stationID;
+			}
+		}
+
+		// conflict set: everything on m* that could start before C*, the priority rule decides
+		ScheduleDecision sd;
+		sd.stationID = station;
+		float bestScore = std::numeric_limits<float>::max();
+		bool chosen = false;
+		for (const Entry& entry : m_stationEntries[station]) {
+			if (entry.earliestStart >= bestCompletion && entry.completion > bestCompletion) continue;
+			const Job& job = jobContainer.getJob(entry.jobID);
+			const Operation& operation = job.getOperation(entry.operationID);
+			OperationTimeStation ots{ station, entry.time };
+			float score = m_priority(jobContainer, schedule, job, operation, ots);
+			if (!chosen || score < bestScore) {
+				chosen = true;
+				bestScore = score;
+				sd.jobID = entry.jobID;
+				sd.operationID = entry.operationID;
+			}
+		}
+		return sd;
+	}
+
+	void GifflerThompson::sync(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		if (m_jobContainer != &jobContainer || m_restartStamp != jobContainer.restartStamp() ||
+			m_stationTime.size() != (size_t)schedule.stationCount()) {
+			build(jobContainer, schedule);
+		}
+
+		// stations that moved: only the start/completion of their entries change
+		for (StationID stationID = 0; stationID < m_stationTime.size(); ++stationID) {
+			int time = schedule.getStationAvabilityTime(stationID);
+			if (time == m_stationTime[stationID]) continue;
+			m_stationTime[stationID] = time;
+			for (Entry& entry : m_stationEntries[stationID]) {
+				entry.earliestStart = std::max(entry.ready, time);
+				entry.completion = entry.earliestStart + entry.time;
+			}
+			m_stationDirty[stationID] = true;
+		}
+
+		// jobs that progressed or were undone get their entries replaced
+		size_t jobIndex = 0;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			uint64_t version = jobIT.second.version();
+			m_jobChanged[jobIndex] = version != m_jobVersion[jobIndex];
+			if (m_jobChanged[jobIndex]) {
+				m_jobVersion[jobIndex] = version;
+				for (StationID stationID : m_jobStations[jobIndex]) m_stationDirty[stationID] = true;
+			}
+			++jobIndex;
+		}
+		for (StationID stationID = 0; stationID < m_stationEntries.size(); ++stationID) {
+			if (!m_stationDirty[stationID]) continue;
+			std::vector<Entry>& entries = m_stationEntries[stationID];
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+				return m_jobChanged[m_jobIndex[entry.jobID]];
+			}), entries.end());
+		}
+		jobIndex = 0;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			if (m_jobChanged[jobIndex]) {
+				const Job& job = jobIT.second;
+				m_jobStations[jobIndex].clear();
+				for (OperationID operationID : job.getAvailibleOperations()) {
+					const Operation& operation = job.getOperation(operationID);
+					int ready = operation.getLastPrecedessorTime();
+					for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+						Entry entry;
+						entry.jobID = job.jobID;
+						entry.operationID = operationID;
+						entry.time = ots.time;
+						entry.ready = ready;
+						entry.earliestStart = std::max(ready, m_stationTime[ots.stationID]);
+						entry.completion = entry.earliestStart + ots.time;
+						m_stationEntries[ots.stationID].push_back(entry);
+						m_jobStations[jobIndex].push_back(ots.stationID);
+						m_stationDirty[ots.stationID] = true;
+					}
+				}
+			}
+			++jobIndex;
+		}
+
+		for (StationID stationID = 0; stationID < m_stationDirty.size(); ++stationID) {
+			if (!m_stationDirty[stationID]) continue;
+			refreshBest(stationID);
+			m_stationDirty[stationID] = false;
+		}
+	}
+
+	void GifflerThompson::build(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		m_jobContainer = &jobContainer;
+		m_restartStamp = jobContainer.restartStamp();
+
+		m_jobIndex.clear();
+		size_t jobCount = 0;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			JobID jobID = jobIT.first;
+			if (m_jobIndex.size() <= jobID) m_jobIndex.resize(jobID + 1, 0);
+			m_jobIndex[jobID] = jobCount++;
+		}
+		m_jobVersion.assign(jobCount, std::numeric_limits<uint64_t>::max());
+		m_jobStations.assign(jobCount, std::vector<StationID>());
+		m_jobChanged.assign(jobCount, false);
+
+		size_t stationCount = schedule.stationCount();
+		m_stationTime.assign(stationCount, 0);
+		m_stationEntries.assign(stationCount, std::vector<Entry>());
+		m_stationBest.assign(stationCount, std::numeric_limits<int>::max());
+		m_stationDirty.assign(stationCount, false);
+	}
+
+	void GifflerThompson::refreshBest(StationID stationID)
+	{
+		int best = std::numeric_limits<int>::max();
+		for (const Entry& entry : m_stationEntries[stationID]) best = std::min(best, entry.completion);
+		m_stationBest[stationID] = best;
+	}
+
+	ScheduleDecision GT_Planner(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		static thread_local GifflerThompson gifflerThompson;
+		return gifflerThompson(jobContainer, schedule);
+	}
+
+	ConstructionSolver::ConstrutionFunction make_GT_Planner(const CandidateScorer& priority)
+	{
+		std::shared_ptr<GifflerThompson> gifflerThompson = std::make_shared<GifflerThompson>(priority);
+		return [gifflerThompson](const JobContainer& jobContainer, const Schedule& schedule) {
+			return (*gifflerThompson)(jobContainer, schedule);
+		};
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+
+namespace ConstructionAlgorithm {
+	/* Giffler-Thompson active schedule generation for the flexible case.
+	   Among all (availible operation, station) pairs the one with the earliest completion time fixes the
+	   station m* and time C*; the conflict set is every pair on m* that could start before C*, and the
+	   priority scorer picks from it. Since the decision always lands on m*'s tail the result plugs into
+	   ConstructionSolver like any other planner.
+	   Completion times are cached per station and only refreshed for jobs whose version changed and
+	   stations whose availability changed since the last call, so undo and restarts are picked up too. */
+	class GifflerThompson {
+	public:
+		explicit GifflerThompson(const CandidateScorer& priority = EET_Score);
+		ScheduleDecision operator()(const JobContainer& jobContainer, const Schedule& schedule);
+
+	private:
+		struct Entry {
+			JobID jobID;
+			OperationID operationID;
+			int time;
+			int ready;
+			int earliestStart;
+			int completion;
+		};
+
+		void sync(const JobContainer& jobContainer, const Schedule& schedule);
+		void build(const JobContainer& jobContainer, const Schedule& schedule);
+		void refreshBest(StationID stationID);
+
+		CandidateScorer m_priority;
+		const JobContainer* m_jobContainer;
+		uint64_t m_restartStamp;
+
+		std::vector<size_t> m_jobIndex;				// jobID -> slot
+		std::vector<uint64_t> m_jobVersion;
+		std::vector<std::vector<StationID>> m_jobStations;	// stations holding entries of the job
+		std::vector<bool> m_jobChanged;
+
+		std::vector<int> m_stationTime;
+		std::vector<std::vector<Entry>> m_stationEntries;
+		std::vector<int> m_stationBest;				// min completion on the station
+		std::vector<bool> m_stationDirty;
+	};
+
+	/* GT with EET as priority (per thread engine) */
+	ScheduleDecision GT_Planner(const JobContainer& jobContainer, const Schedule& schedule);
+	/* GT with its own engine and any rule score as priority */
+	ConstructionSolver::ConstrutionFunction make_GT_Planner(const CandidateScorer& priority);
+}
@@ -0,0 +1,97 @@
+#include "Grasp.h"
+#include "Portfolio.h"
+#include "Parallel.hpp"
+#include <cmath>
+
+namespace ConstructionAlgorithm {
+	ScheduleDecision rclDecision(const JobContainer& jobContainer, const Schedule& schedule, const CandidateScorer& scorer,
+		double alpha, Xoshiro256& rng, std::vector<ScoredDecision>& candidates)
+	{
+		collectCandidates(jobContainer, schedule, scorer, candidates);
+		size_t rclSize = std::max<size_t>(1, (size_t)std::ceil(alpha * candidates.size()));
+		rclSize = std::min(rclSize, candidates.size());
+		auto byScore = [](const ScoredDecision& a, const ScoredDecision& b) { return a.score < b.score; };
+		if (rclSize == 1) {
+			return std::min_element(candidates.begin(), candidates.end(), byScore)->decision;
+		}
+		// only membership matters, order inside the list doesn't
+		std::nth_element(candidates.begin(), candidates.begin() + (rclSize - 1), candidates.end(), byScore);
+		return candidates[rng.uniformInt(rclSize)].decision;
+	}
+
+	ConstructionSolver::ConstrutionFunction make_GRASP_Planner(const CandidateScorer& scorer, double alpha, uint64_t seed)
+	{
+		return [scorer, alpha, rng = Xoshiro256(seed), candidates = std::vector<ScoredDecision>()]
+		(const JobContainer& jobContainer, const Schedule& schedule) mutable {
+			return rclDecision(jobContainer, schedule, scorer, alpha, rng, candidates);
+		};
+	}
+
+	namespace {
+		struct GraspWorker {
+			JobContainer jobContainer;
+			Schedule schedule = Schedule(0);
+			std::unique_ptr<ConstructionSolver> solver;
+			Xoshiro256 rng;
+			Schedule bestSchedule = Schedule(0);
+			size_t bestStart = 0;
+			int bestMakeSpan = std::numeric_limits<int>::max();
+			std::vector<ScoredDecision> candidates;
+		};
+	}
+
+	GraspResult runGrasp(const JobContainer& instance, const GraspOptions& options)
+	{
+		GraspResult result;
+		if (options.starts == 0) return result;
+
+		PlannerConfig callerSettings = threadSettings();
+		unsigned workerCount = std::min<size_t>(Parallel::resolveThreadCount(options.threadCount), options.starts);
+		std::vector<std::unique_ptr<GraspWorker>> workers(workerCount);
+		std::atomic<int> incumbent{ std::numeric_limits<int>::max() };
+
+		Parallel::parallelFor(options.starts, workerCount, [&](size_t start, unsigned workerIndex) {
+			std::unique_ptr<GraspWorker>& worker = workers[workerIndex];
+			if (!worker) {
+				worker.reset(new GraspWorker());
+				worker->jobContainer = instance;
+				worker->schedule = Schedule(instance.stationCount());
+				GraspWorker* self = worker.get();
+				worker->solver.reset(new ConstructionSolver(worker->jobContainer, worker->schedule,
+					[self, &options](const JobContainer& jobContainer, const Schedule& schedule) {
+						return rclDecision(jobContainer, schedule, options.candidateScorer, options.alpha, self->rng, self->candidates);
+					}));
+				callerSettings.apply();
+			}
+			Schedule& schedule = worker->schedule;
+			worker->jobContainer.restartContainer();
+			schedule.clear();
+			worker->rng = Xoshiro256::taskStream(options.seed, start);
+			// only starts that can't even tie the best are cut, so the winner and its start don't depend on timing
+			int best = incumbent.load();
+			worker->solver->setIncumbent(best == std::numeric_limits<int>::max() ? best : best + 1);
+			if (worker->solver->scheduleAll() != SolveStatus::Completed) return;
+
+			int makeSpan = schedule.makeSpan();
+			if (makeSpan < worker->bestMakeSpan || (makeSpan == worker->bestMakeSpan && start < worker->bestStart)) {
+				worker->bestMakeSpan = makeSpan;
+				worker->bestStart = start;
+				worker->bestSchedule = schedule;
+			}
+			int current = incumbent.load();
+			while (makeSpan < current && !incumbent.compare_exchange_weak(current, makeSpan)) {}
+		});
+		callerSettings.apply();
+
+		for (const std::unique_ptr<GraspWorker>& worker : workers) {
+			if (!worker || worker->bestMakeSpan == std::numeric_limits<int>::max()) continue;
+			if (worker->bestMakeSpan < result.bestMakeSpan ||
+				(worker->bestMakeSpan == result.bestMakeSpan && worker->bestStart < result.bestStart)) {
+				result.bestMakeSpan = worker->bestMakeSpan;
+				result.bestStart = worker->bestStart;
+				result.bestSchedule = worker->bestSchedule;
+			}
+		}
+		return result;
+	}
+}
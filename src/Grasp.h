@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+
+namespace ConstructionAlgorithm {
+	/* Randomized rule: uniform pick among the ceil(alpha * count) best scored candidates,
+	   alpha 0 keeps only the best one (the rule itself, up to ties). candidates is scratch space. */
+	ScheduleDecision rclDecision(const JobContainer& jobContainer, const Schedule& schedule, const CandidateScorer& scorer,
+		double alpha, Xoshiro256& rng, std::vector<ScoredDecision>& candidates);
+	/* rclDecision as a planner with its own generator */
+	ConstructionSolver::ConstrutionFunction make_GRASP_Planner(const CandidateScorer& scorer, double alpha, uint64_t seed);
+
+	struct GraspOptions {
+		CandidateScorer candidateScorer = EET_Score;
+		double alpha = 0.1;
+		size_t starts = 1000;
+		uint64_t seed = 1;
+		unsigned threadCount = 0;	// 0 -> hardware concurrency
+	};
+
+	struct GraspResult {
+		Schedule bestSchedule = Schedule(0);
+		size_t bestStart = 0;
+		int bestMakeSpan = std::numeric_limits<int>::max();
+	};
+
+	/* Independent randomized constructions, best makespan wins (ties to the lowest start).
+	   Start i draws from Xoshiro256::taskStream(seed, i), so results don't depend on the thread count.
+	   Workers copy the instance once and restart it per start; after the first starts the
+	   loop reuses its buffers and doesn't allocate. A start is aborted as Dominated once its lower bound
+	   is above the best makespan so far. Scores use the calling thread's planner settings. */
+	GraspResult runGrasp(const JobContainer& instance, const GraspOptions& options = GraspOptions());
+}
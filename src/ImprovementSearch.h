@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+
+namespace ConstructionAlgorithm {
+	/* Improvement method over finished schedules that runs in slices, for drivers that interleave,
+	   migrate or stop searches (islands, budgets). A search is used by one thread at a time. */
+	class ImprovementSearch {
+	public:
+		virtual ~ImprovementSearch() = default;
+
+		/* up to iterations more steps in the method's own unit (moves, generations),
+		   false once the search stopped on its own */
+		virtual bool run(size_t iterations) = 0;
+		virtual int bestMakeSpan() const = 0;
+		virtual Schedule bestSchedule() const = 0;
+		/* a schedule of the same instance found elsewhere, the method decides how to use it */
+		virtual void immigrate(const Schedule& schedule) = 0;
+	};
+}
@@ -0,0 +1,130 @@
+#include "Island.h"
+#include "Parallel.hpp"
+#include "Portfolio.h"
+
+namespace ConstructionAlgorithm {
+	namespace {
+		struct Migrant {
+			Schedule schedule;
+			int makeSpan;
+		};
+
+		/* single slot, exchange only; whoever takes a migrant out of the slot owns it */
+		struct alignas(64) Mailbox {
+			std::atomic<Migrant*> slot{ nullptr };
+
+			~Mailbox() { delete slot.load(); }
+
+			void post(std::unique_ptr<Migrant> migrant) { delete slot.exchange(migrant.release(), std::memory_order_acq_rel); }
+			std::unique_ptr<Migrant> take() { return std::unique_ptr<Migrant>(slot.exchange(nullptr, std::memory_order_acq_rel)); }
+		};
+
+		/* fraction * operation count random station moves, cycles are taken back by the graph */
+		Schedule perturbed(const JobContainer& instance, const Schedule& schedule, double fraction, Xoshiro256& rng)
+		{
+			DisjunctiveGraph graph(instance, schedule);
+			if (graph.nodeCount() == 0) return schedule;
+			size_t moves = (size_t)(fraction * graph.nodeCount()) + 1;
+			for (size_t move = 0; move < moves; ++move) {
+				int node = (int)rng.uniformInt((uint32_t)graph.nodeCount());
+				const OperationTimeStation* alternatives = graph.alternativesBegin(node);
+				StationID stationID = alternatives[rng.uniformInt((uint32_t)(graph.alternativesEnd(node) - alternatives))].stationID;
+				size_t size = graph.sequence(stationID).size() - (stationID == graph.station(node) ? 1 : 0);
+				graph.applyMove(node, stationID, rng.uniformInt((uint32_t)size + 1));
+			}
+			return graph.toSchedule(instance);
+		}
+
+		struct IslandState {
+			std::unique_ptr<ImprovementSearch> search;
+			size_t migrations = 0;
+		};
+	}
+
+	IslandResult runIslands(const IslandFactory& factory, const IslandOptions& options)
+	{
+		IslandResult result;
+		size_t islandCount = options.islandCount != 0 ? options.islandCount : Parallel::resolveThreadCount(0);
+		size_t interval = std::max<size_t>(options.migrationInterval, 1);
+		std::vector<Mailbox> mailboxes(islandCount);
+		std::vector<IslandState> islands(islandCount);
+		PlannerConfig callerSettings = threadSettings();
+
+		// as many workers as islands, each island keeps its thread for the whole run
+		Parallel::parallelFor(islandCount, (unsigned)islandCount, [&](size_t island, unsigned) {
+			IslandState& state = islands[island];
+			callerSettings.apply();
+			state.search = factory(island, Xoshiro256::stream(options.seed, island)());
+			ImprovementSearch& search = *state.search;
+			Mailbox& inbox = mailboxes[island];
+			Mailbox& outbox = mailboxes[(island + 1) % islandCount];
+			int posted = std::numeric_limits<int>::max();
+
+			for (size_t done = 0; done < options.iterations;) {
+				size_t steps = std::min(interval, options.iterations - done);
+				bool running = search.run(steps);
+				done += steps;
+				if (islandCount == 1) {
+					if (!running) break;
+					continue;
+				}
+
+				if (search.bestMakeSpan() < posted) {
+					posted = search.bestMakeSpan();
+					outbox.post(std::unique_ptr<Migrant>(new Migrant{ search.bestSchedule(), posted }));
+				}
+				std::unique_ptr<Migrant> migrant = inbox.take();
+				if (migrant && migrant->makeSpan < search.bestMakeSpan()) {
+					search.immigrate(migrant->schedule);
+					++state.migrations;
+					running = true;
+				}
+				if (!running) break;
+			}
+		});
+
+		for (size_t island = 0; island < islandCount; ++island) {
+			const ImprovementSearch& search = *islands[island].search;
+			result.islandMakeSpans.push_back(search.bestMakeSpan());
+			result.migrations += islands[island].migrations;
+			if (search.bestMakeSpan() < result.bestMakeSpan) {
+				result.bestMakeSpan = search.bestMakeSpan();
+				result.bestIsland = island;
+			}
+		}
+		if (islandCount > 0) result.bestSchedule = islands[result.bestIsland].search->bestSchedule();
+		return result;
+	}
+
+	IslandFactory tabuIslands(const JobContainer& instance, const Schedule& initial, const TabuOptions& options, double perturbation)
+	{
+		return [&instance, initial, options, perturbation](size_t island, uint64_t seed) {
+			TabuOptions islandOptions = options;
+			islandOptions.seed = seed;
+			if (island == 0) return std::unique_ptr<ImprovementSearch>(new TabuSearch(instance, initial, islandOptions));
+			Xoshiro256 rng(seed);
+			return std::unique_ptr<ImprovementSearch>(new TabuSearch(instance, perturbed(instance, initial, perturbation, rng), islandOptions));
+		};
+	}
+
+	IslandFactory annealingIslands(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options, double perturbation)
+	{
+		return [&instance, initial, options, perturbation](size_t island, uint64_t seed) {
+			AnnealingOptions islandOptions = options;
+			islandOptions.seed = seed;
+			if (island == 0) return std::unique_ptr<ImprovementSearch>(new SimulatedAnnealing(instance, initial, islandOptions));
+			Xoshiro256 rng(seed);
+			return std::unique_ptr<ImprovementSearch>(new SimulatedAnnealing(instance, perturbed(instance, initial, perturbation, rng), islandOptions));
+		};
+	}
+
+	IslandFactory geneticIslands(const JobContainer& instance, const GeneticOptions& options)
+	{
+		return [&instance, options](size_t, uint64_t seed) {
+			GeneticOptions islandOptions = options;
+			islandOptions.seed = seed;
+			islandOptions.threadCount = 1;
+			return std::unique_ptr<ImprovementSearch>(new GeneticSearch(instance, islandOptions));
+		};
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "TabuSearch.h"
+#include "Genetic.h"
+#include "Annealing.h"
+#include <functional>
+
+namespace ConstructionAlgorithm {
+	/* builds the search of one island, called on that island's thread (with the caller's planner
+	   settings) and its own seed */
+	using IslandFactory = std::function<std::unique_ptr<ImprovementSearch>(size_t island, uint64_t seed)>;
+
+	struct IslandOptions {
+		size_t islandCount = 0;			// 0 -> hardware concurrency, every island runs on its own thread
+		size_t iterations = 10000;		// per island, in the search's own steps
+		size_t migrationInterval = 100;	// steps between migrations
+		uint64_t seed = 1;
+	};
+
+	struct IslandResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t bestIsland = 0;
+		size_t migrations = 0;			// migrants that improved the island they reached
+		std::vector<int> islandMakeSpans;
+	};
+
+	/* Island model: independent searches, one per thread, on a ring. Every migrationInterval steps an
+	   island posts its best schedule to the next island's mailbox if it improved since the last post, and
+	   takes what its own mailbox holds; a migrant better than the island's best is handed to immigrate().
+	   Mailboxes are single lock-free slots where a newer migrant replaces an unread one, so no island
+	   ever waits for another. Island i gets the seed Xoshiro256::stream(seed, i)(); which migrants arrive
+	   when depends on timing, so runs with more than one island aren't reproducible. */
+	IslandResult runIslands(const IslandFactory& factory, const IslandOptions& options = IslandOptions());
+
+	/* tabu search, island 0 starts from initial and the others from it after perturbation * operation count
+	   random station moves, so they don't all walk the same path */
+	IslandFactory tabuIslands(const JobContainer& instance, const Schedule& initial, const TabuOptions& options = TabuOptions(),
+		double perturbation = 0.05);
+	/* one genetic search per island, each on a single thread */
+	IslandFactory geneticIslands(const JobContainer& instance, const GeneticOptions& options = GeneticOptions());
+	/* simulated annealing, started and perturbed like tabuIslands */
+	IslandFactory annealingIslands(const JobContainer& instance, const Schedule& initial, const AnnealingOptions& options = AnnealingOptions(),
+		double perturbation = 0.05);
+}
@@ -0,0 +1,166 @@
+#include "IteratedGreedy.h"
+#include <cmath>
+
+namespace ConstructionAlgorithm {
+	IteratedGreedyResult iteratedGreedy(const JobContainer& instance, const Schedule& initial, const IteratedGreedyOptions& options)
+	{
+		IteratedGreedyResult result;
+		JobContainer jobContainer = instance;
+		jobContainer.restartContainer();
+		Schedule schedule(instance.stationCount());
+		double averageShortestTime = jobContainer.remainingShortestWork() / (double)std::max(jobContainer.remainingOperationCount(), 1);
+		double temperature = options.temperature * averageShortestTime;
+
+		std::vector<ScheduleDecision> current;
+		stackedDecisions(initial, current);
+		for (const ScheduleDecision& sd : current) {
+			schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+		}
+		if (!jobContainer.isDone()) {
+			throw std::runtime_error("iteratedGreedy: initial schedule doesn't cover the instance");
+		}
+		int currentMakeSpan = schedule.makeSpan();
+		result.bestMakeSpan = currentMakeSpan;
+		result.bestSchedule = schedule;
+		size_t operationCount = current.size();
+		if (operationCount == 0) return result;
+
+		// removedOperation[jobID][operationID]
+		std::vector<JobID> jobIDs;
+		std::vector<std::vector<char>> removedOperation;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			jobIDs.push_back(jobIT.first);
+			if (removedOperation.size() <= jobIT.first) removedOperation.resize(jobIT.first + 1);
+			OperationID lastID = jobIT.second.getOperaions().empty() ? 0 : jobIT.second.getOperaions().rbegin()->first;
+			removedOperation[jobIT.first].assign(lastID + 1, 0);
+		}
+
+		Xoshiro256 rng(options.seed);
+		std::vector<char> removedAt(operationCount);
+		std::vector<char> removedJob(removedOperation.size());
+		std::vector<ScheduleDecision> oldSuffix, kept, rebuilt;
+		std::vector<ScoredDecision> candidates;
+		std::vector<JobID> jobOrder = jobIDs;
+
+		for (size_t iteration = 0; iteration < options.iterations; ++iteration) {
+			// destroy
+			std::fill(removedAt.begin(), removedAt.end(), 0);
+			if (options.destroyMode == DestroyMode::Jobs) {
+				size_t count = std::min(std::max<size_t>(options.destroyJobs, 1), jobOrder.size());
+				std::fill(removedJob.begin(), removedJob.end(), 0);
+				for (size_t i = 0; i < count; ++i) {
+					std::swap(jobOrder[i], jobOrder[i + rng.uniformInt(jobOrder.size() - i)]);
+					removedJob[jobOrder[i]] = 1;
+				}
+				for (size_t i = 0; i < operationCount; ++i) removedAt[i] = removedJob[current[i].jobID];
+			}
+			else {
+				size_t window = std::min(std::max<size_t>(options.destroyWindow, 1), operationCount);
+				size_t begin = rng.uniformInt(operationCount - window + 1);
+				std::fill(removedAt.begin() + begin, removedAt.begin() + begin + window, 1);
+			}
+			size_t destroyPoint = std::find(removedAt.begin(), removedAt.end(), 1) - removedAt.begin();
+
+			oldSuffix.assign(current.begin() + destroyPoint, current.end());
+			kept.clear();
+			for (size_t i = destroyPoint; i < operationCount; ++i) {
+				if (removedAt[i]) removedOperation[current[i].jobID][current[i].operationID] = 1;
+				else kept.push_back(current[i]);
+			}
+			schedule.unstackTo(destroyPoint, jobContainer);
+
+			// rebuild: next kept operation competes with every availible removed one
+			rebuilt.clear();
+			size_t keptCursor = 0;
+			size_t removedLeft = oldSuffix.size() - kept.size();
+			// without a temperature a rebuild worse than the current schedule is rejected anyway, so it stops
+			// once its bound is above it; its own generator keeps the cut from shifting later iterations
+			Xoshiro256 rebuildRng(rng());
+			bool prune = temperature <= 0;
+			bool dominated = false;
+			int jobBound = prune ? jobLowerBound(jobContainer) : 0;
+			while (removedLeft > 0) {
+				if (prune && std::max(jobBound, loadLowerBound(jobContainer, schedule)) > currentMakeSpan) {
+					dominated = true;
+					break;
+				}
+				candidates.clear();
+				if (keptCursor < kept.size()) {
+					const ScheduleDecision& next = kept[keptCursor];
+					const Job& job = jobContainer.getJob(next.jobID);
+					const std::vector<OperationID>& availible = job.getAvailibleOperations();
+					if (std::find(availible.begin(), availible.end(), next.operationID) != availible.end()) {
+						const Operation& operation = job.getOperation(next.operationID);
+						OperationTimeStation ots{ next.stationID, operation.getProcessTimeOnStationID(next.stationID) };
+						candidates.push_back({ next, options.candidateScorer(jobContainer, schedule, job, operation, ots) });
+					}
+				}
+				for (const auto& jobIT : jobContainer.getJobs()) {
+					const Job& job = jobIT.second;
+					for (OperationID operationID : job.getAvailibleOperations()) {
+						if (!removedOperation[job.jobID][operationID]) continue;
+						const Operation& operation = job.getOperation(operationID);
+						for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+							ScoredDecision candidate;
+							candidate.decision = { ots.stationID, operationID, job.jobID };
+							candidate.score = options.candidateScorer(jobContainer, schedule, job, operation, ots);
+							candidates.push_back(candidate);
+						}
+					}
+				}
+
+				auto byScore = [](const ScoredDecision& a, const ScoredDecision& b) { return a.score < b.score; };
+				size_t rclSize = std::min(candidates.size(), std::max<size_t>(1, (size_t)std::ceil(options.alpha * candidates.size())));
+				ScheduleDecision sd;
+				if (rclSize == 1) {
+					sd = std::min_element(candidates.begin(), candidates.end(), byScore)->decision;
+				}
+				else {
+					std::nth_element(candidates.begin(), candidates.begin() + (rclSize - 1), candidates.end(), byScore);
+					sd = candidates[rebuildRng.uniformInt(rclSize)].decision;
+				}
+				ScheduledOperation sop = schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+				if (prune) jobBound = std::max(jobBound, stackedJobBound(jobContainer, sop));
+				rebuilt.push_back(sd);
+				if (keptCursor < kept.size() && kept[keptCursor].jobID == sd.jobID && kept[keptCursor].operationID == sd.operationID) {
+					++keptCursor;
+				}
+				else {
+					--removedLeft;
+				}
+			}
+			// nothing left to decide, the rest of the kept order is replayed without scoring
+			if (!dominated) {
+				for (; keptCursor < kept.size(); ++keptCursor) {
+					const ScheduleDecision& sd = kept[keptCursor];
+					schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+					rebuilt.push_back(sd);
+				}
+			}
+			for (const ScheduleDecision& sd : oldSuffix) removedOperation[sd.jobID][sd.operationID] = 0;
+
+			// accept
+			int makeSpan = dominated ? std::numeric_limits<int>::max() : schedule.makeSpan();
+			bool accept = !dominated && (makeSpan <= currentMakeSpan ||
+				(temperature > 0 && rng.uniformReal() < std::exp(-(makeSpan - currentMakeSpan) / temperature)));
+			if (accept) {
+				current.resize(destroyPoint);
+				current.insert(current.end(), rebuilt.begin(), rebuilt.end());
+				currentMakeSpan = makeSpan;
+				++result.accepted;
+				if (makeSpan < result.bestMakeSpan) {
+					result.bestMakeSpan = makeSpan;
+					result.bestSchedule = schedule;
+					++result.improved;
+				}
+			}
+			else {
+				schedule.unstackTo(destroyPoint, jobContainer);
+				for (const ScheduleDecision& sd : oldSuffix) {
+					schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+				}
+			}
+		}
+		return result;
+	}
+}
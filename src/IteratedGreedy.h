@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+
+namespace ConstructionAlgorithm {
+	enum class DestroyMode {
+		Jobs,	// every operation of destroyJobs random jobs
+		Window	// destroyWindow consecutive operations in stacking order
+	};
+
+	struct IteratedGreedyOptions {
+		CandidateScorer candidateScorer = EET_Score;	// rebuild rule
+		double alpha = 0.1;			// rebuild picks from the best ceil(alpha * count) like rclDecision
+		DestroyMode destroyMode = DestroyMode::Window;
+		size_t destroyJobs = 2;
+		size_t destroyWindow = 12;
+		/* a worse result is accepted with probability exp(-delta / T),
+		   T = temperature * average shortest operation time */
+		double temperature = 0.5;
+		size_t iterations = 1000;
+		uint64_t seed = 1;
+	};
+
+	struct IteratedGreedyResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t accepted = 0;
+		size_t improved = 0;
+	};
+
+	/* Iterated greedy on a finished schedule of the instance. Each iteration removes a set of operations,
+	   unstacks back to the first of them and rebuilds: operations that were kept go back in their old
+	   order on their old stations, interleaved with the removed ones wherever the rule scores them
+	   better. The prefix before the first removed operation is never touched. Until the last removed
+	   operation is placed every step scans the availible operations of all jobs and scores the removed
+	   ones; after that the rest of the kept order is replayed without scoring, as is a rejected rebuild.
+	   In Window mode an iteration so costs destroyWindow scored steps, plus the kept operations the rule
+	   puts before the last removed one, plus a replay of the suffix. In Jobs mode the removed operations
+	   are spread over the whole schedule, so an iteration costs up to a full scored construction.
+	   With temperature 0 a rebuild stops as soon as its lower bound is above the current makespan.
+	   Scores use the calling thread's planner settings. */
+	IteratedGreedyResult iteratedGreedy(const JobContainer& instance, const Schedule& initial,
+		const IteratedGreedyOptions& options = IteratedGreedyOptions());
+}
@@ -0,0 +1,350 @@
+#include "LargeNeighbourhood.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		using Clock = std::chrono::steady_clock;
+
+		enum DestroyOperator { Jobs, StationBlock, TimeWindow, Related };
+	}
+
+	struct LargeNeighbourhoodSearch::State {
+		const JobContainer& instance;
+		LnsOptions options;
+		std::vector<PlannerConfig> repairs;
+		PlannerConfig callerSettings;
+		JobContainer jobContainer;
+		Schedule schedule;
+		Xoshiro256 rng;
+		double temperature;
+		Clock::time_point start;
+
+		// current solution in stacking order with the start time of every decision
+		std::vector<ScheduleDecision> current;
+		std::vector<int> currentStart;
+		int currentMakeSpan = 0;
+		Schedule best;
+		int bestMakeSpan = std::numeric_limits<int>::max();
+
+		// freed[jobID][operationID]
+		std::vector<std::vector<char>> freed;
+		std::vector<JobID> jobOrder;
+		std::vector<char> removedAt;
+		std::vector<size_t> byStart;
+		bool byStartValid = false;
+		std::vector<std::pair<int, size_t>> related;
+		std::vector<char> seedStation;
+		std::vector<ScheduleDecision> oldSuffix, kept, rebuilt;
+		std::vector<int> rebuiltStart;
+		int appliedRepair = -1;
+
+		size_t iteration = 0;
+		size_t accepted = 0;
+		size_t improvements = 0;
+		bool outOfTime = false;
+
+		State(const JobContainer& instance, const Schedule& initial, const LnsOptions& options);
+		void load(const Schedule& initial);
+		bool running();
+		void destroy();
+		void commit(const ScheduleDecision& sd);
+		void repair(const ConstructionSolver::ConstrutionFunction& planner);
+		void step();
+	};
+
+	LargeNeighbourhoodSearch::State::State(const JobContainer& instance, const Schedule& initial, const LnsOptions& options)
+		: instance(instance), options(options), jobContainer(instance), schedule(instance.stationCount()), rng(options.seed),
+		start(Clock::now()), best(instance.stationCount())
+	{
+		callerSettings = threadSettings();
+		repairs = options.repairPlanners;
+		if (repairs.empty()) {
+			PlannerConfig config = callerSettings;
+			config.name = "CP_HF_Planner";
+			config.planner = CP_HF_Planner;
+			repairs.push_back(config);
+			config.name = "HF2_Planner";
+			config.planner = HF2_Planner;
+			repairs.push_back(config);
+		}
+
+		jobContainer.restartContainer();
+		temperature = options.temperature * jobContainer.remainingShortestWork() / (double)std::max(jobContainer.remainingOperationCount(), 1);
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			jobOrder.push_back(jobIT.first);
+			if (freed.size() <= jobIT.first) freed.resize(jobIT.first + 1);
+			OperationID lastID = jobIT.second.getOperaions().empty() ? 0 : jobIT.second.getOperaions().rbegin()->first;
+			freed[jobIT.first].assign(lastID + 1, 0);
+		}
+		seedStation.assign(instance.stationCount(), 0);
+		load(initial);
+	}
+
+	void LargeNeighbourhoodSearch::State::load(const Schedule& initial)
+	{
+		schedule.unstackTo(0, jobContainer);
+		stackedDecisions(initial, current);
+		currentStart.clear();
+		for (const ScheduleDecision& sd : current) {
+			currentStart.push_back(schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer).startTime);
+		}
+		if (!jobContainer.isDone()) {
+			throw std::runtime_error("LargeNeighbourhoodSearch: schedule doesn't cover the instance");
+		}
+		byStartValid = false;
+		currentMakeSpan = schedule.makeSpan();
+		if (currentMakeSpan < bestMakeSpan) {
+			if (bestMakeSpan != std::numeric_limits<int>::max()) ++improvements;
+			bestMakeSpan = currentMakeSpan;
+			best = schedule;
+		}
+	}
+
+	bool LargeNeighbourhoodSearch::State::running()
+	{
+		if (options.timeLimit > 0.0 && !outOfTime) {
+			outOfTime = std::chrono::duration<double>(Clock::now() - start).count() >= options.timeLimit;
+		}
+		return !outOfTime && iteration < options.iterations && !current.empty();
+	}
+
+	void LargeNeighbourhoodSearch::State::destroy()
+	{
+		size_t operationCount = current.size();
+		size_t destroyMin = std::min(std::max<size_t>(options.destroyMin, 1), operationCount);
+		size_t destroyMax = std::min(std::max(options.destroyMax, destroyMin), operationCount);
+		size_t count = destroyMin + rng.uniformInt((uint32_t)(destroyMax - destroyMin + 1));
+		std::fill(removedAt.begin(), removedAt.end(), 0);
+
+		const DestroyWeights& weights = options.destroy;
+		double draw = rng.uniformReal() * (weights.jobs + weights.stationBlock + weights.timeWindow + weights.related);
+		DestroyOperator destroyOperator = Related;
+		if (draw < weights.jobs) destroyOperator = Jobs;
+		else if (draw < weights.jobs + weights.stationBlock) destroyOperator = StationBlock;
+		else if (draw < weights.jobs + weights.stationBlock + weights.timeWindow) destroyOperator = TimeWindow;
+
+		switch (destroyOperator) {
+		case Jobs: {
+			// whole jobs until at least count operations are freed
+			size_t removed = 0;
+			for (size_t i = 0; i < jobOrder.size() && removed < count; ++i) {
+				std::swap(jobOrder[i], jobOrder[i + rng.uniformInt((uint32_t)(jobOrder.size() - i))]);
+				JobID jobID = jobOrder[i];
+				for (size_t index = 0; index < operationCount; ++index) {
+					if (current[index].jobID == jobID) {
+						removedAt[index] = 1;
+						++removed;
+					}
+				}
+			}
+			break;
+		}
+		case StationBlock: {
+			// stacking order is each station's sequence order
+			size_t first = rng.uniformInt((uint32_t)operationCount);
+			StationID stationID = current[first].stationID;
+			for (size_t index = first, removed = 0; index < operationCount && removed < count; ++index) {
+				if (current[index].stationID != stationID) continue;
+				removedAt[index] = 1;
+				++removed;
+			}
+			break;
+		}
+		case TimeWindow: {
+			if (!byStartValid) {
+				byStart.resize(operationCount);
+				for (size_t index = 0; index < operationCount; ++index) byStart[index] = index;
+				std::stable_sort(byStart.begin(), byStart.end(), [this](size_t a, size_t b) { return currentStart[a] < currentStart[b]; });
+				byStartValid = true;
+			}
+			size_t first = rng.uniformInt((uint32_t)(operationCount - count + 1));
+			for (size_t rank = first; rank < first + count; ++rank) removedAt[byStart[rank]] = 1;
+			break;
+		}
+		case Related: {
+			size_t seed = rng.uniformInt((uint32_t)operationCount);
+			const ScheduleDecision& seedDecision = current[seed];
+			const Operation& seedOperation = jobContainer.getJob(seedDecision.jobID).getOperation(seedDecision.operationID);
+			for (const OperationTimeStation& ots : seedOperation.getOperationTimeStations()) seedStation[ots.stationID] = 1;
+			related.clear();
+			for (size_t index = 0; index < operationCount; ++index) {
+				const ScheduleDecision& sd = current[index];
+				bool relatedOperation = sd.jobID == seedDecision.jobID;
+				if (!relatedOperation) {
+					const Operation& operation = jobContainer.getJob(sd.jobID).getOperation(sd.operationID);
+					for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+						if (seedStation[ots.stationID]) {
+							relatedOperation = true;
+							break;
+						}
+					}
+				}
+				if (relatedOperation) related.push_back({ std::abs(currentStart[index] - currentStart[seed]), index });
+			}
+			for (const OperationTimeStation& ots : seedOperation.getOperationTimeStations()) seedStation[ots.stationID] = 0;
+			size_t relatedCount = std::min(count, related.size());
+			std::nth_element(related.begin(), related.begin() + (relatedCount - 1), related.end());
+			for (size_t i = 0; i < relatedCount; ++i) removedAt[related[i].second] = 1;
+			break;
+		}
+		}
+	}
+
+	void LargeNeighbourhoodSearch::State::commit(const ScheduleDecision& sd)
+	{
+		rebuilt.push_back(sd);
+		rebuiltStart.push_back(schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer).startTime);
+	}
+
+	void LargeNeighbourhoodSearch::State::repair(const ConstructionSolver::ConstrutionFunction& planner)
+	{
+		size_t keptCursor = 0;
+		auto keptAvailible = [&]() {
+			if (keptCursor >= kept.size()) return false;
+			const Operation& operation = jobContainer.getJob(kept[keptCursor].jobID).getOperation(kept[keptCursor].operationID);
+			return operation.isAvailible() && !operation.isDone();
+		};
+
+		size_t freedLeft = oldSuffix.size() - kept.size();
+		while (freedLeft > 0) {
+			ScheduleDecision sd = planner(jobContainer, schedule);
+			if (freed[sd.jobID][sd.operationID]) {
+				commit(sd);
+				--freedLeft;
+				continue;
+			}
+			// a frozen operation was picked: the frozen order advances up to it
+			bool advanced = false;
+			while (keptAvailible()) {
+				const ScheduleDecision next = kept[keptCursor++];
+				commit(next);
+				advanced = true;
+				if (next.jobID == sd.jobID && next.operationID == sd.operationID) break;
+			}
+			if (advanced) continue;
+
+			// the frozen order waits on a freed operation of the cursor's job
+			const Job& job = jobContainer.getJob(kept[keptCursor].jobID);
+			ScheduleDecision blocking{ 0, 0, job.jobID };
+			int bestEnd = std::numeric_limits<int>::max();
+			for (OperationID operationID : job.getAvailibleOperations()) {
+				if (!freed[job.jobID][operationID]) continue;
+				for (const OperationTimeStation& ots : job.getOperation(operationID).getOperationTimeStations()) {
+					int end = schedule.fastestEndTimeForScheduleOperation(ots.stationID, operationID, job.jobID, jobContainer);
+					if (end < bestEnd) {
+						bestEnd = end;
+						blocking.stationID = ots.stationID;
+						blocking.operationID = operationID;
+					}
+				}
+			}
+			commit(blocking);
+			--freedLeft;
+		}
+		// nothing left to decide, the rest of the frozen order is replayed without the planner
+		while (keptCursor < kept.size()) commit(kept[keptCursor++]);
+	}
+
+	void LargeNeighbourhoodSearch::State::step()
+	{
+		size_t operationCount = current.size();
+		removedAt.resize(operationCount);
+		destroy();
+		size_t destroyPoint = std::find(removedAt.begin(), removedAt.end(), 1) - removedAt.begin();
+
+		oldSuffix.assign(current.begin() + destroyPoint, current.end());
+		kept.clear();
+		for (size_t i = destroyPoint; i < operationCount; ++i) {
+			if (removedAt[i]) freed[current[i].jobID][current[i].operationID] = 1;
+			else kept.push_back(current[i]);
+		}
+		schedule.unstackTo(destroyPoint, jobContainer);
+
+		int repairIndex = (int)rng.uniformInt((uint32_t)repairs.size());
+		if (repairIndex != appliedRepair) {
+			repairs[repairIndex].apply();
+			appliedRepair = repairIndex;
+		}
+		rebuilt.clear();
+		rebuiltStart.clear();
+		repair(repairs[repairIndex].planner);
+		for (const ScheduleDecision& sd : oldSuffix) freed[sd.jobID][sd.operationID] = 0;
+
+		int makeSpan = schedule.makeSpan();
+		bool accept = makeSpan <= currentMakeSpan ||
+			(temperature > 0 && rng.uniformReal() < std::exp(-(makeSpan - currentMakeSpan) / temperature));
+		if (accept) {
+			current.resize(destroyPoint);
+			current.insert(current.end(), rebuilt.begin(), rebuilt.end());
+			currentStart.resize(destroyPoint);
+			currentStart.insert(currentStart.end(), rebuiltStart.begin(), rebuiltStart.end());
+			byStartValid = false;
+			currentMakeSpan = makeSpan;
+			++accepted;
+			if (makeSpan < bestMakeSpan) {
+				bestMakeSpan = makeSpan;
+				best = schedule;
+				++improvements;
+			}
+		}
+		else {
+			schedule.unstackTo(destroyPoint, jobContainer);
+			for (const ScheduleDecision& sd : oldSuffix) {
+				schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+			}
+		}
+		++iteration;
+	}
+
+	LargeNeighbourhoodSearch::LargeNeighbourhoodSearch(const JobContainer& instance, const Schedule& initial, const LnsOptions& options)
+		: m_state(new State(instance, initial, options))
+	{
+	}
+
+	LargeNeighbourhoodSearch::~LargeNeighbourhoodSearch() = default;
+
+	bool LargeNeighbourhoodSearch::run(size_t iterations)
+	{
+		State& state = *m_state;
+		PlannerConfig caller = threadSettings();
+		state.appliedRepair = -1;
+		for (size_t i = 0; i < iterations && state.running(); ++i) state.step();
+		caller.apply();
+		return state.running();
+	}
+
+	int LargeNeighbourhoodSearch::bestMakeSpan() const
+	{
+		return m_state->bestMakeSpan;
+	}
+
+	Schedule LargeNeighbourhoodSearch::bestSchedule() const
+	{
+		return m_state->best;
+	}
+
+	void LargeNeighbourhoodSearch::immigrate(const Schedule& schedule)
+	{
+		m_state->load(schedule);
+	}
+
+	LnsResult LargeNeighbourhoodSearch::result() const
+	{
+		LnsResult result;
+		result.bestSchedule = m_state->best;
+		result.bestMakeSpan = m_state->bestMakeSpan;
+		result.iterations = m_state->iteration;
+		result.accepted = m_state->accepted;
+		result.improvements = m_state->improvements;
+		return result;
+	}
+
+	LnsResult largeNeighbourhoodSearch(const JobContainer& instance, const Schedule& initial, const LnsOptions& options)
+	{
+		LargeNeighbourhoodSearch search(instance, initial, options);
+		search.run(options.iterations);
+		return search.result();
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Portfolio.h"
+#include "ImprovementSearch.h"
+#include <memory>
+
+namespace ConstructionAlgorithm {
+	/* Relative weights of the destroy operators */
+	struct DestroyWeights {
+		double jobs = 1.0;			// every operation of random jobs
+		double stationBlock = 1.0;	// consecutive operations of one station
+		double timeWindow = 1.0;	// operations adjacent in start time
+		double related = 1.0;		// operations closest in start time to a random one among those sharing its job or an eligible station
+	};
+
+	struct LnsOptions {
+		/* repair planners, one drawn per iteration; empty -> CP_HF and HF2 with the calling thread's params */
+		std::vector<PlannerConfig> repairPlanners;
+		DestroyWeights destroy;
+		size_t destroyMin = 4;		// operations freed per iteration, drawn uniformly from [destroyMin, destroyMax]
+		size_t destroyMax = 16;
+		/* a worse result is accepted with probability exp(-delta / T),
+		   T = temperature * average shortest operation time (as in IteratedGreedyOptions) */
+		double temperature = 0.5;
+		size_t iterations = 5000;
+		double timeLimit = 0.0;		// seconds from construction, 0 -> none
+		uint64_t seed = 1;
+	};
+
+	struct LnsResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t iterations = 0;
+		size_t accepted = 0;
+		size_t improvements = 0;
+	};
+
+	/* Large neighbourhood search on a finished schedule. Each iteration frees a set of operations,
+	   unstacks to the first of them and repairs with a planner: the other operations after that
+	   point stay frozen on their stations and in their old order, the planner's pick is committed when
+	   it is a freed operation and otherwise advances the frozen order up to the picked one (when the
+	   frozen order waits on a freed operation, that job's freed operation goes at its earliest end).
+	   Once every freed operation is placed the rest of the frozen order is replayed without the planner.
+	   Like iteratedGreedy the prefix is never touched and a rejected repair is replayed, so an iteration
+	   costs the suffix after the destroy point and the instance is copied once. */
+	class LargeNeighbourhoodSearch : public ImprovementSearch {
+	public:
+		/* the instance is kept by reference and must outlive the search */
+		LargeNeighbourhoodSearch(const JobContainer& instance, const Schedule& initial, const LnsOptions& options = LnsOptions());
+		~LargeNeighbourhoodSearch() override;
+
+		/* iterations and the time limit count over all runs; the calling thread's planner settings
+		   are restored on return */
+		bool run(size_t iterations) override;
+		int bestMakeSpan() const override;
+		Schedule bestSchedule() const override;
+		/* the search continues from the schedule */
+		void immigrate(const Schedule& schedule) override;
+
+		LnsResult result() const;
+
+	private:
+		struct State;
+		std::unique_ptr<State> m_state;
+	};
+
+	/* LargeNeighbourhoodSearch run until the iterations or the time limit run out */
+	LnsResult largeNeighbourhoodSearch(const JobContainer& instance, const Schedule& initial, const LnsOptions& options = LnsOptions());
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace Parallel {
+	/* 0 -> hardware concurrency (at least 1) */
+	inline unsigned resolveThreadCount(unsigned threadCount) {
+		if (threadCount != 0) return threadCount;
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/* Runs body(index, worker) for index in [0, count) on up to threadCount workers.
+	   Indices are handed out dynamically; anything that must be reproducible should depend
+	   on the index, never on the worker. The first exception thrown by a body is rethrown. */
+	inline void parallelFor(size_t count, unsigned threadCount, const std::function<void(size_t index, unsigned worker)>& body) {
+		unsigned workerCount = (unsigned)std::min<size_t>(resolveThreadCount(threadCount), count);
+		if (workerCount <= 1) {
+			for (size_t i = 0; i < count; ++i) body(i, 0);
+			return;
+		}
+
+		std::atomic<size_t> nextIndex{ 0 };
+		std::exception_ptr error;
+		std::atomic<bool> failed{ false };
+		auto work = [&](unsigned worker) {
+			size_t i;
+			while (!failed.load() && (i = nextIndex.fetch_add(1)) < count) {
+				try {
+					body(i, worker);
+				}
+				catch (...) {
+					if (!failed.exchange(true)) error = std::current_exception();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned worker = 1; worker < workerCount; ++worker) {
+			threads.emplace_back(work, worker);
+		}
+		work(0);
+		for (std::thread& thread : threads) thread.join();
+		if (error) std::rethrow_exception(error);
+	}
+
+	/* Workers that stay alive between parallelFor calls, for loops that fork and join many times
+	   (a rollout per construction step) where starting threads would cost more than the work.
+	   Same contract as Parallel::parallelFor, the calling thread is worker 0. */
+	class WorkerPool {
+	public:
+		explicit WorkerPool(unsigned threadCount = 0) {
+			unsigned workerCount = resolveThreadCount(threadCount);
+			for (unsigned worker = 1; worker < workerCount; ++worker) {
+				m_threads.emplace_back(&WorkerPool::run, this, worker);
+			}
+		}
+
+		~WorkerPool() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& thread : m_threads) thread.join();
+		}
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		unsigned workerCount() const { return (unsigned)m_threads.size() + 1; }
+
+		void parallelFor(size_t count, const std::function<void(size_t index, unsigned worker)>& body) {
+			if (m_threads.empty() || count <= 1) {
+				for (size_t i = 0; i < count; ++i) body(i, 0);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_body = &body;
+				m_count = count;
+				m_nextIndex.store(0);
+				m_failed.store(false);
+				m_error = nullptr;
+				m_active = (unsigned)m_threads.size();
+				++m_round;
+			}
+			m_wake.notify_all();
+			drain(0);
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [&] { return m_active == 0; });
+			m_body = nullptr;
+			if (m_error) std::rethrow_exception(m_error);
+		}
+
+	private:
+		void run(unsigned worker) {
+			uint64_t seenRound = 0;
+			while (true) {
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wake.wait(lock, [&] { return m_stop || m_round != seenRound; });
+					if (m_stop) return;
+					seenRound = m_round;
+				}
+				drain(worker);
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_active == 0) m_done.notify_one();
+			}
+		}
+
+		void drain(unsigned worker) {
+			size_t i;
+			while (!m_failed.load() && (i = m_nextIndex.fetch_add(1)) < m_count) {
+				try {
+					(*m_body)(i, worker);
+				}
+				catch (...) {
+					if (!m_failed.exchange(true)) m_error = std::current_exception();
+				}
+			}
+		}
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_wake, m_done;
+		const std::function<void(size_t, unsigned)>* m_body = nullptr;
+		size_t m_count = 0;
+		std::atomic<size_t> m_nextIndex{ 0 };
+		std::atomic<bool> m_failed{ false };
+		std::exception_ptr m_error;
+		unsigned m_active = 0;
+		uint64_t m_round = 0;
+		bool m_stop = false;
+	};
+}
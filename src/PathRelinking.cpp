@@ -0,0 +1,215 @@
+#include "PathRelinking.h"
+#include "Parallel.hpp"
+#include <cmath>
+#include <optional>
+#include <unordered_set>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		uint64_t mix(uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		}
+
+		/* sum over operations, so it doesn't depend on the order they are visited in */
+		uint64_t scheduleHash(const DisjunctiveGraph& graph)
+		{
+			uint64_t hash = 0;
+			for (size_t node = 0; node < graph.nodeCount(); ++node) {
+				uint64_t station = graph.station((int)node);
+				hash += mix(mix(node ^ (station << 32)) ^ (uint64_t)(graph.stationPredecessor((int)node) + 1));
+			}
+			return hash;
+		}
+
+		int distance(const DisjunctiveGraph& a, const DisjunctiveGraph& b)
+		{
+			int count = 0;
+			for (size_t node = 0; node < a.nodeCount(); ++node) {
+				if (a.station((int)node) != b.station((int)node) || a.stationPredecessor((int)node) != b.stationPredecessor((int)node)) ++count;
+			}
+			return count;
+		}
+
+		/* operations of the guide not yet in place on the matched station prefixes */
+		size_t remaining(const DisjunctiveGraph& graph, const DisjunctiveGraph& guide)
+		{
+			size_t count = 0;
+			for (StationID stationID = 0; stationID < guide.stationCount(); ++stationID) {
+				const std::vector<int>& target = guide.sequence(stationID);
+				const std::vector<int>& sequence = graph.sequence(stationID);
+				size_t k = 0;
+				while (k < target.size() && k < sequence.size() && sequence[k] == target[k]) ++k;
+				count += target.size() - k;
+			}
+			return count;
+		}
+
+		struct Elite {
+			DisjunctiveGraph graph;
+			uint64_t hash;
+		};
+
+		struct ElitePool {
+			size_t capacity;
+			int minDistance;
+			std::vector<Elite> entries;
+
+			bool offer(Elite&& candidate)
+			{
+				size_t closest = 0;
+				int closestDistance = std::numeric_limits<int>::max();
+				for (size_t i = 0; i < entries.size(); ++i) {
+					if (entries[i].hash == candidate.hash) return false;
+					int d = distance(entries[i].graph, candidate.graph);
+					if (d < closestDistance) {
+						closestDistance = d;
+						closest = i;
+					}
+				}
+				if (closestDistance < minDistance) {
+					if (candidate.graph.makeSpan() >= entries[closest].graph.makeSpan()) return false;
+					entries[closest] = std::move(candidate);
+					return true;
+				}
+				if (entries.size() < capacity) {
+					entries.push_back(std::move(candidate));
+					return true;
+				}
+				size_t worst = 0;
+				for (size_t i = 1; i < entries.size(); ++i) {
+					if (entries[i].graph.makeSpan() >= entries[worst].graph.makeSpan()) worst = i;
+				}
+				if (candidate.graph.makeSpan() >= entries[worst].graph.makeSpan()) return false;
+				entries[worst] = std::move(candidate);
+				return true;
+			}
+		};
+
+		struct Path {
+			size_t from;
+			size_t to;
+			std::optional<Elite> best;		// best new point inside the path, after the local search
+			uint64_t pointHash = 0;			// of the point before the local search
+			size_t evaluations = 0;
+			size_t duplicates = 0;
+		};
+
+		void relink(DisjunctiveGraph graph, const DisjunctiveGraph& guide, const std::unordered_set<uint64_t>& seen, Path& path)
+		{
+			int bestMakeSpan = std::numeric_limits<int>::max();
+			while (true) {
+				int bestNode = -1;
+				StationID bestStation = 0;
+				size_t bestPosition = 0;
+				int stepMakeSpan = std::numeric_limits<int>::max();
+				for (StationID stationID = 0; stationID < guide.stationCount(); ++stationID) {
+					const std::vector<int>& target = guide.sequence(stationID);
+					const std::vector<int>& sequence = graph.sequence(stationID);
+					size_t k = 0;
+					while (k < target.size() && k < sequence.size() && sequence[k] == target[k]) ++k;
+					if (k == target.size()) continue;
+
+					int node = target[k];
+					StationID oldStation = graph.station(node);
+					size_t oldPosition = graph.position(node);
+					if (!graph.applyMove(node, stationID, k)) continue;
+					++path.evaluations;
+					int makeSpan = graph.makeSpan();
+					graph.applyMove(node, oldStation, oldPosition);
+					if (makeSpan < stepMakeSpan) {
+						stepMakeSpan = makeSpan;
+						bestNode = node;
+						bestStation = stationID;
+						bestPosition = k;
+					}
+				}
+				// at the guide, or every open step would close a cycle
+				if (bestNode < 0) break;
+				graph.applyMove(bestNode, bestStation, bestPosition);
+				if (remaining(graph, guide) == 0) break;
+				if (graph.makeSpan() >= bestMakeSpan) continue;
+
+				uint64_t hash = scheduleHash(graph);
+				if (seen.count(hash)) {
+					++path.duplicates;
+					continue;
+				}
+				bestMakeSpan = graph.makeSpan();
+				path.best = Elite{ graph, hash };
+				path.pointHash = hash;
+			}
+		}
+	}
+
+	RelinkingResult pathRelinking(const JobContainer& instance, const std::vector<Schedule>& elite, const RelinkingOptions& options)
+	{
+		RelinkingResult result;
+		if (elite.empty()) return result;
+		ElitePool pool;
+		pool.capacity = std::max<size_t>(options.poolSize, 2);
+		std::unordered_set<uint64_t> seen;
+		for (const Schedule& schedule : elite) {
+			DisjunctiveGraph graph(instance, schedule);
+			uint64_t hash = scheduleHash(graph);
+			pool.minDistance = std::max(1, (int)std::ceil(options.minDistance * graph.nodeCount()));
+			seen.insert(hash);
+			pool.offer(Elite{ std::move(graph), hash });
+		}
+
+		Parallel::WorkerPool workers(options.threadCount);
+		std::unordered_set<uint64_t> relinked;
+		std::vector<Path> paths;
+		for (size_t round = 0; round < options.rounds; ++round) {
+			paths.clear();
+			for (size_t from = 0; from < pool.entries.size(); ++from) {
+				for (size_t to = 0; to < pool.entries.size(); ++to) {
+					if (from == to) continue;
+					uint64_t pair = mix(pool.entries[from].hash ^ mix(pool.entries[to].hash));
+					if (!relinked.insert(pair).second) continue;
+					paths.push_back(Path{ from, to, std::nullopt });
+				}
+			}
+			if (paths.empty()) break;
+			++result.rounds;
+
+			workers.parallelFor(paths.size(), [&](size_t index, unsigned) {
+				Path& path = paths[index];
+				relink(pool.entries[path.from].graph, pool.entries[path.to].graph, seen, path);
+				if (!path.best || options.tabuIterations == 0) return;
+				TabuOptions tabu;
+				tabu.iterations = options.tabuIterations;
+				TabuSearch search(instance, path.best->graph.toSchedule(instance), tabu);
+				search.run(options.tabuIterations);
+				if (search.bestMakeSpan() < path.best->graph.makeSpan()) {
+					DisjunctiveGraph improved(instance, search.bestSchedule());
+					uint64_t hash = scheduleHash(improved);
+					path.best = Elite{ std::move(improved), hash };
+				}
+			});
+
+			bool changed = false;
+			for (Path& path : paths) {
+				++result.paths;
+				result.evaluations += path.evaluations;
+				result.duplicates += path.duplicates;
+				if (!path.best) continue;
+				seen.insert(path.pointHash);
+				seen.insert(path.best->hash);
+				changed |= pool.offer(std::move(*path.best));
+			}
+			if (!changed) break;
+		}
+
+		size_t best = 0;
+		for (size_t i = 0; i < pool.entries.size(); ++i) {
+			result.poolMakeSpans.push_back(pool.entries[i].graph.makeSpan());
+			if (pool.entries[i].graph.makeSpan() < pool.entries[best].graph.makeSpan()) best = i;
+		}
+		result.bestMakeSpan = pool.entries[best].graph.makeSpan();
+		result.bestSchedule = pool.entries[best].graph.toSchedule(instance);
+		return result;
+	}
+}
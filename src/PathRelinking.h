@@ -0,0 +1,38 @@
+#pragma once
+
+#include "TabuSearch.h"
+
+namespace ConstructionAlgorithm {
+	struct RelinkingOptions {
+		size_t poolSize = 10;
+		/* pool members differ in at least minDistance * operation count operations, counting an operation
+		   once when its station or its predecessor on the station differs */
+		double minDistance = 0.05;
+		size_t rounds = 5;				// stops earlier once a round leaves the pool unchanged
+		size_t tabuIterations = 1000;	// local search from the best point of every path, 0 -> none
+		unsigned threadCount = 0;		// 0 -> hardware concurrency
+	};
+
+	struct RelinkingResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t rounds = 0;
+		size_t paths = 0;
+		size_t evaluations = 0;			// moves applied and taken back while choosing steps
+		size_t duplicates = 0;			// path points skipped because their hash was seen before
+		std::vector<int> poolMakeSpans;
+	};
+
+	/* Path relinking as an intensification phase, e.g. on PortfolioResult::schedules (keepSchedules) or
+	   GeneticSearch::population(). The schedules fill a diverse elite pool; every round walks from each
+	   member towards every other one it wasn't relinked with. A step moves one operation to its station and
+	   place in the guiding schedule, the station sequences are matched front to back, and among the steps
+	   open on the stations the one with the lowest makespan is taken (measured with the disjunctive
+	   graph's incremental update and taken back). The best point strictly inside a path whose hash (station
+	   and station predecessor of every operation) wasn't seen before is improved by tabu search and offered
+	   to the pool: a duplicate is dropped, one closer than minDistance to a member replaces that member if
+	   it is better, otherwise it takes a free place or replaces the worst. Paths of a round run in parallel
+	   and are merged in pair order, so the result doesn't depend on the thread count. */
+	RelinkingResult pathRelinking(const JobContainer& instance, const std::vector<Schedule>& elite,
+		const RelinkingOptions& options = RelinkingOptions());
+}
@@ -1,6 +1,7 @@
 //#include "Utils.hpp"
 #include <limits>
 #include "FJSS.hpp"
+#include "Random.hpp"
 
 // ---------------------- 0 planning algoritm ----------------------------
 // best machine + operation but jobs iteratively
@@ -39,7 +40,7 @@ fjss::StationID findBestAvailibleStation(const fjss::Operation& operation, const
 // ---------------------- 1 planning algoritm ----------------------------
 // random dispatching = baseline
 
-fjss::Schedule planRandom(fjss::JobContainer& jobContainer, unsigned stationCount) {
+fjss::Schedule planRandom(fjss::JobContainer& jobContainer, unsigned stationCount, fjss::Xoshiro256& random) {
 	fjss::Schedule schedule(stationCount);
 
 	for (auto& jobIT : jobContainer.getJobs()) {
@@ -48,7 +49,7 @@ fjss::Schedule planRandom(fjss::JobContainer& jobContainer, unsigned stationCoun
 			const std::vector<fjss::OperationID>& avbOpsIDs = job.getAvailibleOperations();
 			fjss::OperationID opID = avbOpsIDs.front();
 			const fjss::Operation& operation = job.getOperation(opID);
-			int randomStation = rand() % operation.getOperationTimeStations().size();
+			int randomStation = random.uniformInt((uint32_t)operation.getOperationTimeStations().size());
 			fjss::StationID bestStationID = operation.getOperationTimeStations()[randomStation].stationID;
 			schedule.stackScheduleOperation(bestStationID, opID, job.jobID, jobContainer);
 		}
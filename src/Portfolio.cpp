@@ -0,0 +1,110 @@
+#include "Portfolio.h"
+#include "Parallel.hpp"
+
+namespace ConstructionAlgorithm {
+	void PlannerConfig::apply() const
+	{
+		dispatch_operation_mode = operationMode;
+		dispatch_station_mode = stationMode;
+		ConstructionAlgorithm::params = this->params;
+	}
+
+	PlannerConfig threadSettings()
+	{
+		PlannerConfig settings;
+		settings.operationMode = dispatch_operation_mode;
+		settings.stationMode = dispatch_station_mode;
+		settings.params = params;
+		return settings;
+	}
+
+	std::vector<PlannerConfig> dispatchConfigs(int operationRuleCount, int stationRuleCount)
+	{
+		std::vector<PlannerConfig> configs;
+		for (int station = 0; station < stationRuleCount; ++station) {
+			for (int operation = 0; operation < operationRuleCount; ++operation) {
+				PlannerConfig config;
+				config.name = "OP" + std::to_string(operation) + " - ST" + std::to_string(station);
+				config.planner = Dispatch_Planner;
+				config.operationMode = operation;
+				config.stationMode = station;
+				configs.push_back(config);
+			}
+		}
+		return configs;
+	}
+
+	namespace {
+		struct PortfolioWorker {
+			JobContainer jobContainer;
+			Schedule schedule = Schedule(0);
+			Schedule bestSchedule = Schedule(0);
+			size_t bestIndex = 0;
+			int bestMakeSpan = std::numeric_limits<int>::max();
+		};
+	}
+
+	PortfolioResult runPortfolio(const JobContainer& instance, const std::vector<PlannerConfig>& configs,
+		const PortfolioOptions& options)
+	{
+		PortfolioResult result;
+		result.makeSpans.assign(configs.size(), -1);
+		if (configs.empty()) return result;
+
+		// the calling thread works too, give its settings back afterwards
+		PlannerConfig callerSettings = threadSettings();
+
+		unsigned workerCount = std::min<size_t>(Parallel::resolveThreadCount(options.threadCount), configs.size());
+		std::vector<std::unique_ptr<PortfolioWorker>> workers(workerCount);
+		std::atomic<int> incumbent{ std::numeric_limits<int>::max() };
+		std::vector<Schedule> completed(options.keepSchedules > 0 ? configs.size() : 0, Schedule(0));
+
+		Parallel::parallelFor(configs.size(), workerCount, [&](size_t index, unsigned workerIndex) {
+			std::unique_ptr<PortfolioWorker>& worker = workers[workerIndex];
+			if (!worker) {
+				// one copy per worker, solver restarts it for every config
+				worker.reset(new PortfolioWorker());
+				worker->jobContainer = instance;
+				worker->schedule = Schedule(instance.stationCount());
+			}
+			const PlannerConfig& config = configs[index];
+			config.apply();
+			worker->schedule.clear();
+			ConstructionSolver solver(worker->jobContainer, worker->schedule, config.planner);
+			if (options.pruneDominated) solver.setIncumbent(incumbent.load());
+			if (solver.scheduleAll() != SolveStatus::Completed) return;
+
+			int makeSpan = worker->schedule.makeSpan();
+			result.makeSpans[index] = makeSpan;
+			if (options.keepSchedules > 0) completed[index] = worker->schedule;
+			if (makeSpan < worker->bestMakeSpan || (makeSpan == worker->bestMakeSpan && index < worker->bestIndex)) {
+				worker->bestMakeSpan = makeSpan;
+				worker->bestIndex = index;
+				worker->bestSchedule = worker->schedule;
+			}
+			int current = incumbent.load();
+			while (makeSpan < current && !incumbent.compare_exchange_weak(current, makeSpan)) {}
+		});
+		callerSettings.apply();
+
+		for (const std::unique_ptr<PortfolioWorker>& worker : workers) {
+			if (!worker || worker->bestMakeSpan == std::numeric_limits<int>::max()) continue;
+			if (worker->bestMakeSpan < result.bestMakeSpan ||
+				(worker->bestMakeSpan == result.bestMakeSpan && worker->bestIndex < result.bestIndex)) {
+				result.bestMakeSpan = worker->bestMakeSpan;
+				result.bestIndex = worker->bestIndex;
+				result.bestSchedule = worker->bestSchedule;
+			}
+		}
+		if (options.keepSchedules > 0) {
+			std::vector<size_t> order;
+			for (size_t index = 0; index < configs.size(); ++index) {
+				if (result.makeSpans[index] >= 0) order.push_back(index);
+			}
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return result.makeSpans[a] < result.makeSpans[b]; });
+			order.resize(std::min(order.size(), options.keepSchedules));
+			for (size_t index : order) result.schedules.push_back(std::move(completed[index]));
+		}
+		return result;
+	}
+}
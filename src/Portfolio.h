@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ConstructionAlgorithms.h"
+#include <string>
+
+namespace ConstructionAlgorithm {
+	/* Planner plus the per thread settings it reads (dispatch modes, params) */
+	struct PlannerConfig {
+		std::string name;
+		ConstructionSolver::ConstrutionFunction planner;
+		int operationMode = 0;
+		int stationMode = 0;
+		std::vector<double> params;
+
+		/* Loads the settings into the calling thread */
+		void apply() const;
+	};
+
+	/* Settings of the calling thread (planner left empty), for workers that must run like the caller */
+	PlannerConfig threadSettings();
+
+	/* Dispatch_Planner for every (operation rule, station rule) pair, station major like main's plannerProgram */
+	std::vector<PlannerConfig> dispatchConfigs(int operationRuleCount = 10, int stationRuleCount = 3);
+
+	struct PortfolioResult {
+		Schedule bestSchedule = Schedule(0);
+		size_t bestIndex = 0;
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		std::vector<int> makeSpans;		// per config, -1 when the run was pruned as dominated
+		std::vector<Schedule> schedules;	// the keepSchedules best, best first, e.g. to seed pathRelinking
+	};
+
+	struct PortfolioOptions {
+		unsigned threadCount = 0;		// 0 -> hardware concurrency
+		bool pruneDominated = false;	// abort runs that can't beat the best so far
+		size_t keepSchedules = 0;		// number of best schedules returned in PortfolioResult::schedules, 0 -> none
+	};
+
+	/* Runs every config on the instance in parallel. The instance is only read; every worker copies it
+	   once and restarts its copy between configs. Best is the lowest makespan, ties to the lowest index
+	   (with pruning the index among ties depends on timing, the makespan doesn't). */
+	PortfolioResult runPortfolio(const JobContainer& instance, const std::vector<PlannerConfig>& configs,
+		const PortfolioOptions& options = PortfolioOptions());
+}
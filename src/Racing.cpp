@@ -0,0 +1,163 @@
+#include "Racing.h"
+#include <cmath>
+#include <numeric>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		/* Acklam's rational approximation of the standard normal quantile */
+		double normalQuantile(double p)
+		{
+			static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+				1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+			static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+				6.680131188771972e+01, -1.328068155288572e+01 };
+			static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+				-2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+			static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+				3.754408661907416e+00 };
+			if (p < 0.02425) {
+				double q = std::sqrt(-2 * std::log(p));
+				return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+					((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+			}
+			if (p > 1 - 0.02425) return -normalQuantile(1 - p);
+			double q = p - 0.5;
+			double r = q * q;
+			return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+				(((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+		}
+
+		/* Wilson-Hilferty */
+		double chiSquaredQuantile(double p, double df)
+		{
+			double z = normalQuantile(p);
+			double h = 2.0 / (9.0 * df);
+			return df * std::pow(1.0 - h + z * std::sqrt(h), 3);
+		}
+
+		/* Cornish-Fisher expansion around the normal quantile */
+		double studentQuantile(double p, double df)
+		{
+			double z = normalQuantile(p);
+			double z3 = z * z * z;
+			double z5 = z3 * z * z;
+			return z + (z3 + z) / (4 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df);
+		}
+
+		/* ranks 1..n, ties get their average rank */
+		void rankRow(const std::vector<double>& values, std::vector<double>& ranks)
+		{
+			std::vector<size_t> order(values.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+			ranks.assign(values.size(), 0);
+			for (size_t i = 0; i < order.size();) {
+				size_t j = i;
+				while (j + 1 < order.size() && values[order[j + 1]] == values[order[i]]) ++j;
+				double rank = (i + j) / 2.0 + 1.0;
+				for (size_t k = i; k <= j; ++k) ranks[order[k]] = rank;
+				i = j + 1;
+			}
+		}
+	}
+
+	RaceResult raceConfigs(const std::vector<JobContainer>& problems, const std::vector<PlannerConfig>& configs,
+		const RaceOptions& options)
+	{
+		RaceResult result;
+		result.eliminatedAfter.assign(configs.size(), -1);
+		result.problemsRun.assign(configs.size(), 0);
+		result.meanMakeSpan.assign(configs.size(), 0);
+
+		std::vector<size_t> alive(configs.size());
+		std::iota(alive.begin(), alive.end(), 0);
+		// makeSpans[problem][config]
+		std::vector<std::vector<double>> makeSpans;
+
+		PortfolioOptions portfolioOptions;
+		portfolioOptions.threadCount = options.threadCount;
+
+		std::vector<double> rankSums, row, ranks;
+		for (size_t problemIndex = 0; problemIndex < problems.size(); ++problemIndex) {
+			std::vector<int> aliveMakeSpans;
+			if (options.evaluate) {
+				aliveMakeSpans = options.evaluate(problemIndex, alive);
+			}
+			else {
+				std::vector<PlannerConfig> aliveConfigs;
+				for (size_t config : alive) aliveConfigs.push_back(configs[config]);
+				aliveMakeSpans = (options.cache ?
+					runPortfolioCached(problems[problemIndex], aliveConfigs, *options.cache, portfolioOptions) :
+					runPortfolio(problems[problemIndex], aliveConfigs, portfolioOptions)).makeSpans;
+			}
+			result.evaluations += alive.size();
+
+			makeSpans.emplace_back(configs.size(), -1.0);
+			for (size_t i = 0; i < alive.size(); ++i) {
+				makeSpans.back()[alive[i]] = aliveMakeSpans[i];
+				result.meanMakeSpan[alive[i]] += aliveMakeSpans[i];
+				++result.problemsRun[alive[i]];
+			}
+
+			int blocks = problemIndex + 1;
+			size_t k = alive.size();
+			if (k <= options.minSurvivors || k < 2 || blocks < options.firstTest ||
+				(blocks - options.firstTest) % std::max(options.testEvery, 1) != 0) continue;
+
+			// Friedman test over the survivors, every survivor ran every problem so far
+			rankSums.assign(k, 0);
+			double squaredRankSum = 0;
+			for (const std::vector<double>& problemRow : makeSpans) {
+				row.clear();
+				for (size_t config : alive) row.push_back(problemRow[config]);
+				rankRow(row, ranks);
+				for (size_t i = 0; i < k; ++i) {
+					rankSums[i] += ranks[i];
+					squaredRankSum += ranks[i] * ranks[i];
+				}
+			}
+			double b = blocks;
+			double tieTerm = squaredRankSum - b * k * (k + 1) * (k + 1) / 4.0;
+			if (tieTerm <= 0) continue;
+			double deviation = 0;
+			for (double rankSum : rankSums) deviation += std::pow(rankSum - b * (k + 1) / 2.0, 2);
+			double statistic = (k - 1) * deviation / tieTerm;
+			if (statistic <= chiSquaredQuantile(1 - options.alpha, k - 1)) continue;
+
+			// Conover post-hoc: drop everything significantly worse than the best rank sum
+			double df = (b - 1) * (k - 1);
+			double spread = std::sqrt(std::max(0.0, 2 * b * (1 - statistic / (b * (k - 1))) * tieTerm / df));
+			double threshold = studentQuantile(1 - options.alpha / 2, df) * spread;
+			double bestRankSum = *std::min_element(rankSums.begin(), rankSums.end());
+
+			std::vector<size_t> stillAlive;
+			for (size_t i = 0; i < k; ++i) {
+				if (rankSums[i] - bestRankSum > threshold) {
+					result.eliminatedAfter[alive[i]] = blocks;
+				}
+				else {
+					stillAlive.push_back(alive[i]);
+				}
+			}
+			alive = stillAlive;
+		}
+
+		for (size_t config = 0; config < configs.size(); ++config) {
+			if (result.problemsRun[config] > 0) result.meanMakeSpan[config] /= result.problemsRun[config];
+		}
+
+		// order survivors by mean rank over everything they ran
+		rankSums.assign(alive.size(), 0);
+		for (const std::vector<double>& problemRow : makeSpans) {
+			row.clear();
+			for (size_t config : alive) row.push_back(problemRow[config]);
+			rankRow(row, ranks);
+			for (size_t i = 0; i < alive.size(); ++i) rankSums[i] += ranks[i];
+		}
+		std::vector<size_t> order(alive.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return rankSums[a] < rankSums[b]; });
+		for (size_t i : order) result.survivors.push_back(alive[i]);
+		return result;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Portfolio.h"
+#include "ResultCache.h"
+#include <functional>
+
+namespace ConstructionAlgorithm {
+	/* F-race: configs run problem by problem, from firstTest on a Friedman test over makespan ranks
+	   decides whether the survivors differ, and if so every config whose rank sum is significantly
+	   worse than the best one is dropped. */
+	struct RaceOptions {
+		unsigned threadCount = 0;	// 0 -> hardware concurrency
+		int firstTest = 5;			// problems run before the first test
+		int testEvery = 1;			// problems between tests
+		double alpha = 0.05;
+		size_t minSurvivors = 1;	// stop testing when this few are left
+		ResultCache* cache = nullptr;	// runs found here are reused, new ones stored
+		/* makespans of configs[alive[i]] on problems[problem]; empty -> runPortfolio (runPortfolioCached
+		   with a cache) per problem; when set, threadCount and cache are up to the callback. Lets a caller
+		   keep instance copies and threads between races */
+		std::function<std::vector<int>(size_t problem, const std::vector<size_t>& alive)> evaluate;
+	};
+
+	struct RaceResult {
+		std::vector<size_t> survivors;		// config indices, lowest mean rank first
+		std::vector<int> eliminatedAfter;	// problems run before the config was dropped, -1 for survivors
+		std::vector<int> problemsRun;
+		std::vector<double> meanMakeSpan;	// over the problems the config ran
+		size_t evaluations = 0;
+	};
+
+	RaceResult raceConfigs(const std::vector<JobContainer>& problems, const std::vector<PlannerConfig>& configs,
+		const RaceOptions& options = RaceOptions());
+}
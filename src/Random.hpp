@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+namespace fjss {
+	/* xoshiro256** generator (Blackman, Vigna), seeded through splitmix64.
+	   Every solver / generator owns its instance, nothing touches global rand() state.
+	   Parallel work gets its streams with stream(seed, taskIndex): the stream depends on the
+	   task index and not on the thread that runs it, so a fixed seed gives identical results
+	   for any thread count. */
+	class Xoshiro256 {
+	public:
+		using result_type = uint64_t;
+
+		explicit Xoshiro256(uint64_t seed = 0x853c49e6748fea9bull) { this->seed(seed); }
+
+		void seed(uint64_t seed) {
+			for (int i = 0; i < 4; ++i) {
+				seed += 0x9e3779b97f4a7c15ull;
+				uint64_t z = seed;
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				m_state[i] = z ^ (z >> 31);
+			}
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		result_type operator()() {
+			const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+			const uint64_t t = m_state[1] << 17;
+			m_state[2] ^= m_state[0];
+			m_state[3] ^= m_state[1];
+			m_state[1] ^= m_state[2];
+			m_state[0] ^= m_state[3];
+			m_state[2] ^= t;
+			m_state[3] = rotl(m_state[3], 45);
+			return result;
+		}
+
+		/* Advances the state by 2^128 calls, streams between jumps never overlap */
+		void jump() {
+			static const uint64_t JUMP[] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+			uint64_t s[4] = { 0, 0, 0, 0 };
+			for (uint64_t jumpWord : JUMP) {
+				for (int b = 0; b < 64; ++b) {
+					if (jumpWord & (uint64_t(1) << b)) {
+						for (int i = 0; i < 4; ++i) s[i] ^= m_state[i];
+					}
+					(*this)();
+				}
+			}
+			for (int i = 0; i < 4; ++i) m_state[i] = s[i];
+		}
+
+		/* Returns a generator on the current stream and moves this one to the next stream */
+		Xoshiro256 split() {
+			Xoshiro256 child = *this;
+			jump();
+			return child;
+		}
+
+		/* Independent stream number streamIndex of the given seed */
+		static Xoshiro256 stream(uint64_t seed, size_t streamIndex) {
+			Xoshiro256 rng(seed);
+			for (size_t i = 0; i < streamIndex; ++i) rng.jump();
+			return rng;
+		}
+
+		/* O(1) alternative to stream for very many short tasks: the task index is mixed into the
+		   seed instead of jumping, so streams are distinct but not provably non overlapping */
+		static Xoshiro256 taskStream(uint64_t seed, uint64_t taskIndex) {
+			uint64_t z = taskIndex + 0x9e3779b97f4a7c15ull;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return Xoshiro256(seed ^ z ^ (z >> 31));
+		}
+
+		/* Uniform integer in [0, n), Lemire's multiply-shift with rejection */
+		uint32_t uniformInt(uint32_t n) {
+			uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+			uint32_t low = (uint32_t)m;
+			if (low < n) {
+				uint32_t threshold = (uint32_t)(-n) % n;
+				while (low < threshold) {
+					m = (uint64_t)(uint32_t)((*this)() >> 32) * n;
+					low = (uint32_t)m;
+				}
+			}
+			return (uint32_t)(m >> 32);
+		}
+
+		/* Uniform double in [0, 1) */
+		double uniformReal() {
+			return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+	private:
+		static uint64_t rotl(uint64_t x, int k) {
+			return (x << k) | (x >> (64 - k));
+		}
+
+		uint64_t m_state[4];
+	};
+}
@@ -0,0 +1,107 @@
+#include "ReassignmentEvaluator.h"
+#include <algorithm>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		/* first position in [from, to) where the predicate stops holding, it must hold on a prefix */
+		template<typename Predicate>
+		size_t partitionPoint(size_t from, size_t to, Predicate predicate)
+		{
+			while (from < to) {
+				size_t middle = from + (to - from) / 2;
+				if (predicate(middle)) from = middle + 1;
+				else to = middle;
+			}
+			return from;
+		}
+	}
+
+	bool ReassignmentEvaluator::bestInsertion(const DisjunctiveGraph& graph, int node, StationID stationID, int time, Insertion& insertion)
+	{
+		const std::vector<int>& sequence = graph.sequence(stationID);
+		size_t size = sequence.size();
+		int reachLimit = graph.end(node);						// heads at or past this may depend on node
+		int leadLimit = graph.time(node) + graph.tail(node);	// tails at or past this may lead to node
+		size_t low = partitionPoint(0, size, [&](size_t p) { return graph.tail(sequence[p]) >= leadLimit; });
+		size_t high = partitionPoint(0, size, [&](size_t p) { return graph.head(sequence[p]) < reachLimit; });
+		if (low > high) return false;
+
+		auto previousEnd = [&](size_t p) { return p > 0 ? graph.end(sequence[p - 1]) : 0; };
+		auto nextLead = [&](size_t p) { return p < size ? graph.time(sequence[p]) + graph.tail(sequence[p]) : 0; };
+		int ready = graph.jobReady(node);
+		int jobTail = graph.jobTail(node);
+		auto estimate = [&](size_t p) { return std::max(ready, previousEnd(p)) + time + std::max(jobTail, nextLead(p)); };
+
+		// [low, readyEnd): the job predecessors decide the head, [leadBegin, high]: the job successors the tail
+		size_t readyEnd = partitionPoint(low, high + 1, [&](size_t p) { return previousEnd(p) <= ready; });
+		size_t leadBegin = partitionPoint(low, high + 1, [&](size_t p) { return nextLead(p) > jobTail; });
+
+		size_t best = size + 1;
+		int bestEstimate = std::numeric_limits<int>::max();
+		auto consider = [&](size_t p) {
+			int value = estimate(p);
+			if (value < bestEstimate || (value == bestEstimate && p < best)) {
+				best = p;
+				bestEstimate = value;
+			}
+		};
+		if (readyEnd > low) consider(readyEnd - 1);
+		if (leadBegin <= high) consider(leadBegin);
+		if (readyEnd < leadBegin) consider(minimumGap(index(graph, stationID), readyEnd, leadBegin));
+
+		insertion.position = best;
+		insertion.predecessor = best > 0 ? sequence[best - 1] : -1;
+		insertion.estimate = bestEstimate;
+		return true;
+	}
+
+	int ReassignmentEvaluator::exactMakeSpan(DisjunctiveGraph& graph, int node, StationID stationID, size_t position)
+	{
+		StationID oldStation = graph.station(node);
+		size_t oldPosition = graph.position(node);
+		if (!graph.applyMove(node, stationID, position)) return -1;
+		int makeSpan = graph.makeSpan();
+		graph.applyMove(node, oldStation, oldPosition);
+		return makeSpan;
+	}
+
+	const ReassignmentEvaluator::GapIndex& ReassignmentEvaluator::index(const DisjunctiveGraph& graph, StationID stationID)
+	{
+		if (m_indexes.size() < graph.stationCount()) m_indexes.resize(graph.stationCount());
+		GapIndex& index = m_indexes[stationID];
+		if (index.stamp == m_stamp) return index;
+		index.stamp = m_stamp;
+
+		const std::vector<int>& sequence = graph.sequence(stationID);
+		size_t count = sequence.size() + 1;
+		index.gaps.resize(count);
+		for (size_t p = 0; p < count; ++p) {
+			int previousEnd = p > 0 ? graph.end(sequence[p - 1]) : 0;
+			int nextLead = p < sequence.size() ? graph.time(sequence[p]) + graph.tail(sequence[p]) : 0;
+			index.gaps[p] = previousEnd + nextLead;
+		}
+
+		// bottom-up segment tree of positions, leaves at count + p
+		index.tree.resize(2 * count);
+		for (size_t p = 0; p < count; ++p) index.tree[count + p] = (int)p;
+		for (size_t i = count; i-- > 1;) index.tree[i] = better(index, index.tree[2 * i], index.tree[2 * i + 1]);
+		return index;
+	}
+
+	int ReassignmentEvaluator::better(const GapIndex& index, int left, int right)
+	{
+		if (index.gaps[right] != index.gaps[left]) return index.gaps[right] < index.gaps[left] ? right : left;
+		return std::min(left, right);
+	}
+
+	size_t ReassignmentEvaluator::minimumGap(const GapIndex& index, size_t from, size_t to)
+	{
+		size_t count = index.gaps.size();
+		int best = (int)from;
+		for (from += count, to += count; from < to; from /= 2, to /= 2) {
+			if (from & 1) best = better(index, best, index.tree[from++]);
+			if (to & 1) best = better(index, best, index.tree[--to]);
+		}
+		return best;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "DisjunctiveGraph.h"
+
+namespace ConstructionAlgorithm {
+	/* Best insertion of an operation on another station, from the heads and tails of an evaluated graph.
+	   Along a station sequence heads rise and tails fall, so the positions that can't close a cycle are one
+	   range found by binary search. The estimate at position p is
+	       max(jobReady, end(p - 1)) + time + max(jobTail, time(p) + tail(p))
+	   with a prefix of the range where jobReady dominates (best at its end), a suffix where jobTail does
+	   (best at its start) and in between end(p - 1) + time(p) + tail(p), the path through the gap in front
+	   of p. That last term is kept per station in a segment tree (the gap index), so a query is a few
+	   binary searches and one range minimum, exactly the value a scan over the range finds.
+	   Indexes are built lazily per station and dropped by invalidate() once the graph changed. */
+	class ReassignmentEvaluator {
+	public:
+		struct Insertion {
+			size_t position;		// in the target sequence
+			int predecessor;		// station predecessor the node gets, -1 for none
+			int estimate;			// longest path through the node after the move
+		};
+
+		void invalidate() { ++m_stamp; }
+
+		/* false if no position on the station is safe */
+		bool bestInsertion(const DisjunctiveGraph& graph, int node, StationID stationID, int time, Insertion& insertion);
+
+		/* makespan after the move, the graph is put back afterwards; -1 when the move closes a cycle */
+		static int exactMakeSpan(DisjunctiveGraph& graph, int node, StationID stationID, size_t position);
+
+	private:
+		struct GapIndex {
+			size_t stamp = 0;
+			std::vector<int> gaps;						// end(p - 1) + time(p) + tail(p) for p in [0, size]
+			std::vector<int> tree;						// segment tree over gaps holding the position of the minimum
+		};
+
+		const GapIndex& index(const DisjunctiveGraph& graph, StationID stationID);
+		/* smaller gap, the lower position on ties */
+		static int better(const GapIndex& index, int left, int right);
+		static size_t minimumGap(const GapIndex& index, size_t from, size_t to);
+
+		std::vector<GapIndex> m_indexes;
+		size_t m_stamp = 1;
+	};
+}
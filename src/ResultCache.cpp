@@ -0,0 +1,290 @@
+#include "ResultCache.h"
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		/* FNV-1a over 64 bit words */
+		struct Hasher {
+			uint64_t value = 0xcbf29ce484222325ull;
+
+			void add(uint64_t word)
+			{
+				for (int i = 0; i < 8; ++i) {
+					value ^= (word >> (8 * i)) & 0xff;
+					value *= 0x100000001b3ull;
+				}
+			}
+			void add(double number)
+			{
+				uint64_t bits;
+				std::memcpy(&bits, &number, sizeof(bits));
+				add(bits);
+			}
+			void add(const std::string& text)
+			{
+				add((uint64_t)text.size());
+				for (char c : text) {
+					value ^= (unsigned char)c;
+					value *= 0x100000001b3ull;
+				}
+			}
+		};
+	}
+
+	uint64_t instanceHash(const JobContainer& jobContainer)
+	{
+		Hasher hasher;
+		std::vector<std::pair<StationID, int>> alternatives;
+		std::vector<OperationID> predecessors;
+		hasher.add((uint64_t)jobContainer.stationCount());
+		hasher.add((uint64_t)jobContainer.getJobs().size());
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			hasher.add((uint64_t)jobIT.first);
+			hasher.add((uint64_t)jobIT.second.getOperaions().size());
+			for (const auto& operationIT : jobIT.second.getOperaions()) {
+				const Operation& operation = operationIT.second;
+				alternatives.clear();
+				for (const OperationTimeStation& ots : operation.getOperationTimeStations()) alternatives.push_back({ ots.stationID, ots.time });
+				std::sort(alternatives.begin(), alternatives.end());
+				predecessors = operation.getPredecessors();
+				std::sort(predecessors.begin(), predecessors.end());
+
+				hasher.add((uint64_t)operationIT.first);
+				hasher.add((uint64_t)alternatives.size());
+				for (const auto& alternative : alternatives) {
+					hasher.add((uint64_t)alternative.first);
+					hasher.add((uint64_t)(int64_t)alternative.second);
+				}
+				hasher.add((uint64_t)predecessors.size());
+				for (OperationID predecessorID : predecessors) hasher.add((uint64_t)predecessorID);
+			}
+		}
+		return hasher.value;
+	}
+
+	// ------------------------------ ResultCache
+
+	ResultCache::ResultCache(const std::string& path)
+	{
+		if (path.empty()) return;
+		load(path);
+		m_file.open(path, std::ios::app);
+	}
+
+	uint64_t ResultCache::configHash(const PlannerConfig& config)
+	{
+		Hasher hasher;
+		hasher.add(config.name);
+		hasher.add((uint64_t)(int64_t)config.operationMode);
+		hasher.add((uint64_t)(int64_t)config.stationMode);
+		hasher.add((uint64_t)config.params.size());
+		for (double param : config.params) hasher.add(param);
+		return hasher.value;
+	}
+
+	bool ResultCache::find(uint64_t instance, const PlannerConfig& config, Entry& entry) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find({ instance, configHash(config) });
+		if (it == m_entries.end()) return false;
+		entry = it->second;
+		return true;
+	}
+
+	void ResultCache::insert(uint64_t instance, const PlannerConfig& config, int makeSpan, const Schedule* schedule)
+	{
+		Entry entry;
+		entry.makeSpan = makeSpan;
+		if (schedule) stackedDecisions(*schedule, entry.decisions);
+		uint64_t configKey = configHash(config);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_file.is_open()) {
+			// instance config "name" makespan count {station operation job}
+			m_file << std::hex << instance << " " << configKey << std::dec << " " << std::quoted(config.name) << " "
+				<< makeSpan << " " << entry.decisions.size();
+			for (const ScheduleDecision& sd : entry.decisions) {
+				m_file << " " << sd.stationID << " " << sd.operationID << " " << sd.jobID;
+			}
+			m_file << "\n";
+		}
+		m_entries[{ instance, configKey }] = std::move(entry);
+	}
+
+	void ResultCache::flush()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_file.is_open()) m_file.flush();
+	}
+
+	size_t ResultCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+
+	void ResultCache::load(const std::string& path)
+	{
+		std::ifstream ifs(path);
+		std::string line, name;
+		while (std::getline(ifs, line)) {
+			std::istringstream ls(line);
+			Key key;
+			Entry entry;
+			size_t count = 0;
+			if (!(ls >> std::hex >> key.instance >> key.config >> std::dec >> std::quoted(name) >> entry.makeSpan >> count)) continue;
+			entry.decisions.resize(count);
+			bool complete = true;
+			for (ScheduleDecision& sd : entry.decisions) {
+				if (!(ls >> sd.stationID >> sd.operationID >> sd.jobID)) {
+					complete = false;
+					break;
+				}
+			}
+			if (complete) m_entries[key] = std::move(entry);
+		}
+	}
+
+	// ------------------------------ Cached portfolio
+
+	namespace {
+		/* config indices with a makespan, best first, ties in config order as runPortfolio keeps them */
+		std::vector<size_t> bestFirst(const std::vector<int>& makeSpans, size_t count)
+		{
+			std::vector<size_t> order;
+			for (size_t index = 0; index < makeSpans.size(); ++index) {
+				if (makeSpans[index] >= 0) order.push_back(index);
+			}
+			std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return makeSpans[a] < makeSpans[b]; });
+			order.resize(std::min(order.size(), count));
+			return order;
+		}
+
+		/* a cached stacking order replayed on the instance, false if there is none or it doesn't give the
+		   cached makespan */
+		bool replay(const JobContainer& instance, const ResultCache::Entry& entry, Schedule& schedule)
+		{
+			if (entry.decisions.empty()) return false;
+			JobContainer jobContainer = instance;
+			jobContainer.restartContainer();
+			schedule = Schedule(instance.stationCount());
+			for (const ScheduleDecision& sd : entry.decisions) {
+				schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+			}
+			return jobContainer.isDone() && schedule.makeSpan() == entry.makeSpan;
+		}
+	}
+
+	PortfolioResult runPortfolioCached(const JobContainer& instance, const std::vector<PlannerConfig>& configs,
+		ResultCache& cache, const PortfolioOptions& options)
+	{
+		PortfolioResult result;
+		result.makeSpans.assign(configs.size(), -1);
+		uint64_t hash = instanceHash(instance);
+
+		std::vector<ResultCache::Entry> entries(configs.size());
+		std::vector<size_t> missing;
+		std::vector<PlannerConfig> missingConfigs;
+		for (size_t i = 0; i < configs.size(); ++i) {
+			if (cache.find(hash, configs[i], entries[i])) {
+				result.makeSpans[i] = entries[i].makeSpan;
+			}
+			else {
+				missing.push_back(i);
+				missingConfigs.push_back(configs[i]);
+			}
+		}
+
+		// with keepSchedules every run schedule is kept (and cached), any of them may end up in the best few
+		PortfolioResult run;
+		std::vector<Schedule> runSchedules;
+		if (!missing.empty()) {
+			PortfolioOptions runOptions = options;
+			if (options.keepSchedules > 0) runOptions.keepSchedules = missing.size();
+			run = runPortfolio(instance, missingConfigs, runOptions);
+			if (options.keepSchedules > 0) {
+				runSchedules.assign(missing.size(), Schedule(0));
+				std::vector<size_t> order = bestFirst(run.makeSpans, missing.size());
+				for (size_t k = 0; k < order.size(); ++k) runSchedules[order[k]] = std::move(run.schedules[k]);
+			}
+			for (size_t k = 0; k < missing.size(); ++k) {
+				int makeSpan = run.makeSpans[k];
+				result.makeSpans[missing[k]] = makeSpan;
+				if (makeSpan < 0) continue;
+				bool best = k == run.bestIndex && run.bestMakeSpan == makeSpan;
+				const Schedule* schedule = best ? &run.bestSchedule : nullptr;
+				if (!runSchedules.empty()) schedule = &runSchedules[k];
+				cache.insert(hash, configs[missing[k]], makeSpan, schedule);
+			}
+		}
+
+		for (size_t i = 0; i < configs.size(); ++i) {
+			if (result.makeSpans[i] >= 0 && result.makeSpans[i] < result.bestMakeSpan) {
+				result.bestMakeSpan = result.makeSpans[i];
+				result.bestIndex = i;
+			}
+		}
+		if (result.bestMakeSpan == std::numeric_limits<int>::max()) {
+			cache.flush();
+			return result;
+		}
+
+		// the keepSchedules best from the run, from cached stacking orders, or rerun together if neither is there
+		if (options.keepSchedules > 0) {
+			std::vector<size_t> order = bestFirst(result.makeSpans, options.keepSchedules);
+			std::vector<Schedule> kept(order.size(), Schedule(0));
+			std::vector<size_t> rerun;
+			std::vector<PlannerConfig> rerunConfigs;
+			for (size_t j = 0; j < order.size(); ++j) {
+				auto runIndex = std::find(missing.begin(), missing.end(), order[j]);
+				if (runIndex != missing.end()) {
+					kept[j] = std::move(runSchedules[runIndex - missing.begin()]);
+				}
+				else if (!replay(instance, entries[order[j]], kept[j])) {
+					rerun.push_back(j);
+					rerunConfigs.push_back(configs[order[j]]);
+				}
+			}
+			if (!rerun.empty()) {
+				PortfolioOptions rerunOptions;
+				rerunOptions.threadCount = options.threadCount;
+				rerunOptions.keepSchedules = rerun.size();
+				PortfolioResult again = runPortfolio(instance, rerunConfigs, rerunOptions);
+				std::vector<size_t> againOrder = bestFirst(again.makeSpans, rerun.size());
+				for (size_t k = 0; k < againOrder.size(); ++k) {
+					size_t j = rerun[againOrder[k]];
+					kept[j] = std::move(again.schedules[k]);
+					cache.insert(hash, configs[order[j]], again.makeSpans[againOrder[k]], &kept[j]);
+				}
+			}
+			for (Schedule& schedule : kept) {
+				if (schedule.stationCount() > 0) result.schedules.push_back(std::move(schedule));
+			}
+		}
+
+		// missing keeps config order, so a best among the run configs is the run's best
+		auto runIndex = std::find(missing.begin(), missing.end(), result.bestIndex);
+		bool haveSchedule = false;
+		if (!result.schedules.empty()) {
+			result.bestSchedule = result.schedules.front();
+			haveSchedule = true;
+		}
+		else if (runIndex != missing.end()) {
+			result.bestSchedule = run.bestSchedule;
+			haveSchedule = true;
+		}
+		else if (replay(instance, entries[result.bestIndex], result.bestSchedule)) {
+			haveSchedule = true;
+		}
+		if (!haveSchedule) {
+			PortfolioResult single = runPortfolio(instance, { configs[result.bestIndex] }, options);
+			result.bestSchedule = single.bestSchedule;
+			if (single.makeSpans[0] >= 0) cache.insert(hash, configs[result.bestIndex], single.makeSpans[0], &single.bestSchedule);
+		}
+		cache.flush();
+		return result;
+	}
+}
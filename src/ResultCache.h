@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Portfolio.h"
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace ConstructionAlgorithm {
+	/* Content hash of the instance: station count, jobs and operations in ID order, alternatives sorted
+	   by station and predecessors sorted, so the same problem hashes the same however it was loaded */
+	uint64_t instanceHash(const JobContainer& jobContainer);
+
+	/* Persistent (instance, planner config) -> makespan cache.
+	   The file is append-only, one result per line; loading replays it into an in-memory index and a later
+	   line for the same key wins. A half written last line (crash) is skipped. Configs are told apart by
+	   name, dispatch modes and params, the planner function itself can't be hashed, so a config whose
+	   planner changed needs a new name (or a fresh file). Safe to share between threads. */
+	class ResultCache {
+	public:
+		struct Entry {
+			int makeSpan = -1;
+			std::vector<ScheduleDecision> decisions;	// stacking order, empty if the schedule wasn't kept
+		};
+
+		/* empty path -> memory only */
+		explicit ResultCache(const std::string& path = "");
+
+		static uint64_t configHash(const PlannerConfig& config);
+
+		bool find(uint64_t instance, const PlannerConfig& config, Entry& entry) const;
+		void insert(uint64_t instance, const PlannerConfig& config, int makeSpan, const Schedule* schedule = nullptr);
+		void flush();
+		size_t size() const;
+
+	private:
+		struct Key {
+			uint64_t instance;
+			uint64_t config;
+			bool operator==(const Key& other) const { return instance == other.instance && config == other.config; }
+		};
+		struct KeyHash {
+			size_t operator()(const Key& key) const { return (size_t)(key.instance ^ (key.config * 0x9E3779B97F4A7C15ull)); }
+		};
+
+		void load(const std::string& path);
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<Key, Entry, KeyHash> m_entries;
+		std::ofstream m_file;
+	};
+
+	/* runPortfolio that only runs configs missing from the cache and stores what it ran.
+	   The best schedule comes from the run, from a cached stacking order replayed on the instance, or if
+	   neither is there from rerunning the best config alone. With keepSchedules the same goes for the
+	   keepSchedules best: run configs cache their stacking orders, and the cached ones that have none are
+	   rerun together. Pruned runs (-1) aren't cached. */
+	PortfolioResult runPortfolioCached(const JobContainer& instance, const std::vector<PlannerConfig>& configs,
+		ResultCache& cache, const PortfolioOptions& options = PortfolioOptions());
+}
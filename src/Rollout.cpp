@@ -0,0 +1,149 @@
+#include "Rollout.h"
+#include "Parallel.hpp"
+
+namespace ConstructionAlgorithm {
+	namespace {
+		struct RolloutWorker {
+			JobContainer jobContainer;
+			Schedule schedule = Schedule(0);
+			uint64_t sourceStamp = 0;	// restart stamp of the container the copy follows
+			size_t syncedCall = 0;
+		};
+
+		class RolloutPlanner {
+		public:
+			RolloutPlanner(const RolloutOptions& options);
+			ScheduleDecision operator()(const JobContainer& jobContainer, const Schedule& schedule);
+
+		private:
+			void follow(RolloutWorker& worker, const JobContainer& jobContainer, const Schedule& schedule);
+			int rollout(RolloutWorker& worker, const ScheduleDecision& decision, const std::atomic<int>& incumbent);
+
+			RolloutOptions options;
+			Parallel::WorkerPool pool;		// started once, every decision's rollouts run on it
+			std::vector<std::unique_ptr<RolloutWorker>> workers;
+			std::vector<ScoredDecision> candidates;
+			std::vector<int> values;
+			size_t callCount;
+			int rolloutsLeft;
+			uint64_t budgetStamp;
+		};
+
+		RolloutPlanner::RolloutPlanner(const RolloutOptions& _options)
+			:options(_options),
+			pool((unsigned)std::min<size_t>(Parallel::resolveThreadCount(_options.threadCount), std::max<size_t>(_options.topK, 1)))
+		{
+			workers.resize(pool.workerCount());
+			callCount = 0;
+			rolloutsLeft = 0;
+			budgetStamp = 0;
+		}
+
+		ScheduleDecision RolloutPlanner::operator()(const JobContainer& jobContainer, const Schedule& schedule)
+		{
+			// budget is per construction
+			if (budgetStamp != jobContainer.restartStamp()) {
+				budgetStamp = jobContainer.restartStamp();
+				rolloutsLeft = options.rolloutBudget;
+			}
+			collectCandidates(jobContainer, schedule, options.candidateScorer, candidates);
+			size_t rolloutCount = std::min(options.topK, candidates.size());
+			if (rolloutsLeft >= 0) rolloutCount = std::min<size_t>(rolloutCount, rolloutsLeft);
+			keepBestCandidates(candidates, std::max<size_t>(rolloutCount, 1));
+			if (rolloutCount <= 1) return candidates.front().decision;
+			if (rolloutsLeft >= 0) rolloutsLeft -= rolloutCount;
+
+			// the calling thread works too, give its settings back afterwards
+			PlannerConfig callerSettings = threadSettings();
+
+			++callCount;
+			values.assign(rolloutCount, 0);
+			std::atomic<int> incumbent{ std::numeric_limits<int>::max() };
+			pool.parallelFor(rolloutCount, [&](size_t index, unsigned workerIndex) {
+				std::unique_ptr<RolloutWorker>& worker = workers[workerIndex];
+				if (!worker) worker.reset(new RolloutWorker());
+				if (worker->syncedCall != callCount) {
+					follow(*worker, jobContainer, schedule);
+					worker->syncedCall = callCount;
+				}
+				options.basePlanner.apply();
+				values[index] = rollout(*worker, candidates[index].decision, incumbent);
+				int current = incumbent.load();
+				while (values[index] < current && !incumbent.compare_exchange_weak(current, values[index])) {}
+			});
+			callerSettings.apply();
+
+			size_t best = std::min_element(values.begin(), values.end()) - values.begin();
+			return candidates[best].decision;
+		}
+
+		void RolloutPlanner::follow(RolloutWorker& worker, const JobContainer& jobContainer, const Schedule& schedule)
+		{
+			if (worker.sourceStamp == jobContainer.restartStamp() && worker.schedule.stationCount() == schedule.stationCount()) {
+				// replay what the real schedule stacked since the last call, after undoing anything it took back
+				worker.schedule.unstackTo(std::min(worker.schedule.scheduledCount(), schedule.scheduledCount()), worker.jobContainer);
+				const std::vector<std::vector<ScheduledOperation>>& source = schedule.getSchedule();
+				const std::vector<StationID>& stackOrder = schedule.getStackOrder();
+				bool inSync = true;
+				for (size_t i = worker.schedule.scheduledCount(); i < stackOrder.size() && inSync; ++i) {
+					StationID stationID = stackOrder[i];
+					size_t position = worker.schedule.getSchedule()[stationID].size();
+					if (position >= source[stationID].size()) {
+						inSync = false;
+						break;
+					}
+					const ScheduledOperation& sop = source[stationID][position];
+					const std::vector<OperationID>& availible = worker.jobContainer.getJob(sop.jobID).getAvailibleOperations();
+					if (std::find(availible.begin(), availible.end(), sop.operationID) == availible.end()) {
+						inSync = false;
+						break;
+					}
+					worker.schedule.stackScheduleOperation(stationID, sop.operationID, sop.jobID, worker.jobContainer);
+				}
+				// the real schedule may have been taken back further than the copy knows, compare the station tails
+				for (StationID stationID = 0; inSync && stationID < source.size(); ++stationID) {
+					const std::vector<ScheduledOperation>& copy = worker.schedule.getSchedule()[stationID];
+					if (copy.size() != source[stationID].size()) inSync = false;
+					else if (!copy.empty() && (copy.back().jobID != source[stationID].back().jobID ||
+						copy.back().operationID != source[stationID].back().operationID ||
+						copy.back().startTime != source[stationID].back().startTime)) inSync = false;
+				}
+				if (inSync) return;
+			}
+			worker.jobContainer = jobContainer;
+			worker.schedule = schedule;
+			worker.sourceStamp = jobContainer.restartStamp();
+		}
+
+		int RolloutPlanner::rollout(RolloutWorker& worker, const ScheduleDecision& decision, const std::atomic<int>& incumbent)
+		{
+			JobContainer& jobContainer = worker.jobContainer;
+			Schedule& schedule = worker.schedule;
+			size_t mark = schedule.scheduledCount();
+			schedule.stackScheduleOperation(decision.stationID, decision.operationID, decision.jobID, jobContainer);
+			// full rollouts stop once they can't even tie the best finished one, so the pick doesn't depend on timing
+			bool prune = options.rolloutDepth < 0;
+			int jobBound = prune ? jobLowerBound(jobContainer) : 0;
+			for (int step = 0; !jobContainer.isDone() && (options.rolloutDepth < 0 || step < options.rolloutDepth); ++step) {
+				if (prune && std::max(jobBound, loadLowerBound(jobContainer, schedule)) > incumbent.load()) {
+					schedule.unstackTo(mark, jobContainer);
+					return std::numeric_limits<int>::max();
+				}
+				ScheduleDecision sd = options.basePlanner.planner(jobContainer, schedule);
+				ScheduledOperation sop = schedule.stackScheduleOperation(sd.stationID, sd.operationID, sd.jobID, jobContainer);
+				if (prune) jobBound = std::max(jobBound, stackedJobBound(jobContainer, sop));
+			}
+			int value = jobContainer.isDone() ? schedule.makeSpan() : loadLowerBound(jobContainer, schedule);
+			schedule.unstackTo(mark, jobContainer);
+			return value;
+		}
+	}
+
+	ConstructionSolver::ConstrutionFunction make_Rollout_Planner(const RolloutOptions& options)
+	{
+		std::shared_ptr<RolloutPlanner> planner = std::make_shared<RolloutPlanner>(options);
+		return [planner](const JobContainer& jobContainer, const Schedule& schedule) {
+			return (*planner)(jobContainer, schedule);
+		};
+	}
+}
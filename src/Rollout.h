@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Portfolio.h"
+
+namespace ConstructionAlgorithm {
+	/* Pilot method: every step the topK best candidates of candidateScorer are each completed with the
+	   base planner, and the candidate whose rollout ends with the lowest makespan is committed
+	   (ties to the better scored one). */
+	struct RolloutOptions {
+		CandidateScorer candidateScorer = EET_Score;
+		PlannerConfig basePlanner = { "EET", EET_Planner, 0, 0, {} };	// completes the rollouts, its settings are applied per worker
+		size_t topK = 4;
+		int rolloutDepth = -1;		// base planner steps per rollout, -1 -> to the end; cut rollouts are rated by loadLowerBound
+		int rolloutBudget = -1;		// rollouts per construction, once used up the scorer alone decides; -1 -> unlimited
+		unsigned threadCount = 0;	// 0 -> hardware concurrency, never more than topK
+	};
+
+	/* Rollouts run on per worker copies of the instance that follow the real schedule by replaying its
+	   new operations and roll back with the undo trail, so a rollout costs no copy. Full rollouts are
+	   cut once their lower bound is above the best finished rollout of the same step. The returned
+	   planner keeps that state, give every solver its own one. */
+	ConstructionSolver::ConstrutionFunction make_Rollout_Planner(const RolloutOptions& options = RolloutOptions());
+}
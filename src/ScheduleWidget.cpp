@@ -20,10 +20,6 @@ ScheduleWidget::ScheduleWidget()
 	m_triangleShape.setPointCount(3);
 	m_triangleShape.setFillColor(ScheduleUi::gridColor);
 
-	for (int i = 0; i < 20; ++i) {
-		m_colorJobIdMap[i] = sf::Color(rand() % 255, rand() % 255, rand() % 255);
-	}
-
 	m_schedule = nullptr;
 	m_currentLongestOperation = 1;
 	m_jobFollowMode = false;
@@ -0,0 +1,226 @@
+#include "Selector.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <algorithm>
+
+namespace ConstructionAlgorithm {
+	std::vector<double> instanceFeatures(const JobContainer& jobContainer)
+	{
+		InstanceFeatures features = FeatureExtractor::extract(jobContainer);
+		return std::vector<double>(features.values.begin(), features.values.end());
+	}
+
+	// ------------------------------ RegressionTree
+
+	void RegressionTree::fit(const std::vector<std::vector<double>>& samples, const std::vector<double>& targets,
+		int maxDepth, size_t minLeafSize)
+	{
+		m_nodes.clear();
+		if (samples.empty()) return;
+		std::vector<size_t> indices(samples.size());
+		std::iota(indices.begin(), indices.end(), 0);
+		grow(samples, targets, indices, 0, indices.size(), 0, maxDepth, std::max<size_t>(minLeafSize, 1));
+	}
+
+	int RegressionTree::grow(const std::vector<std::vector<double>>& samples, const std::vector<double>& targets,
+		std::vector<size_t>& indices, size_t begin, size_t end, int depth, int maxDepth, size_t minLeafSize)
+	{
+		int nodeIndex = (int)m_nodes.size();
+		m_nodes.push_back(Node());
+		size_t count = end - begin;
+		double sum = 0, squareSum = 0;
+		for (size_t i = begin; i < end; ++i) {
+			sum += targets[indices[i]];
+			squareSum += targets[indices[i]] * targets[indices[i]];
+		}
+		m_nodes[nodeIndex].value = count > 0 ? sum / count : 0;
+		if (depth >= maxDepth || count < 2 * minLeafSize) return nodeIndex;
+
+		// best split by squared error, thresholds halfway between neighbouring distinct values
+		double parentError = squareSum - (count > 0 ? sum * sum / count : 0);
+		double bestError = parentError - 1e-12;
+		int bestFeature = -1;
+		double bestThreshold = 0;
+		size_t featureCount = samples[indices[begin]].size();
+		for (size_t feature = 0; feature < featureCount; ++feature) {
+			std::sort(indices.begin() + begin, indices.begin() + end, [&](size_t a, size_t b) {
+				return samples[a][feature] < samples[b][feature];
+			});
+			double leftSum = 0, leftSquareSum = 0;
+			for (size_t i = begin; i + 1 < end; ++i) {
+				double target = targets[indices[i]];
+				leftSum += target;
+				leftSquareSum += target * target;
+				size_t leftCount = i + 1 - begin;
+				size_t rightCount = count - leftCount;
+				if (leftCount < minLeafSize || rightCount < minLeafSize) continue;
+				double value = samples[indices[i]][feature];
+				double next = samples[indices[i + 1]][feature];
+				if (value == next) continue;
+				double rightSum = sum - leftSum;
+				double error = leftSquareSum - leftSum * leftSum / leftCount +
+					(squareSum - leftSquareSum) - rightSum * rightSum / rightCount;
+				if (error < bestError) {
+					bestError = error;
+					bestFeature = (int)feature;
+					bestThreshold = (value + next) / 2;
+				}
+			}
+		}
+		if (bestFeature == -1) return nodeIndex;
+
+		size_t middle = std::partition(indices.begin() + begin, indices.begin() + end, [&](size_t i) {
+			return samples[i][bestFeature] <= bestThreshold;
+		}) - indices.begin();
+		m_nodes[nodeIndex].feature = bestFeature;
+		m_nodes[nodeIndex].threshold = bestThreshold;
+		int left = grow(samples, targets, indices, begin, middle, depth + 1, maxDepth, minLeafSize);
+		int right = grow(samples, targets, indices, middle, end, depth + 1, maxDepth, minLeafSize);
+		m_nodes[nodeIndex].left = left;
+		m_nodes[nodeIndex].right = right;
+		return nodeIndex;
+	}
+
+	double RegressionTree::predict(const std::vector<double>& features) const
+	{
+		if (m_nodes.empty()) return 0;
+		int nodeIndex = 0;
+		while (m_nodes[nodeIndex].feature != -1) {
+			const Node& node = m_nodes[nodeIndex];
+			nodeIndex = features[node.feature] <= node.threshold ? node.left : node.right;
+		}
+		return m_nodes[nodeIndex].value;
+	}
+
+	// ------------------------------ PlannerSelector
+
+	void PlannerSelector::train(const std::vector<std::string>& plannerNames, const std::vector<std::vector<double>>& samples,
+		const std::vector<std::vector<double>>& makeSpans, int maxDepth, size_t minLeafSize)
+	{
+		m_plannerNames = plannerNames;
+		m_trees.assign(plannerNames.size(), RegressionTree());
+
+		std::vector<double> best(samples.size(), std::numeric_limits<double>::max());
+		for (size_t sample = 0; sample < samples.size(); ++sample) {
+			for (double makeSpan : makeSpans[sample]) {
+				if (makeSpan > 0) best[sample] = std::min(best[sample], makeSpan);
+			}
+		}
+
+		std::vector<std::vector<double>> plannerSamples;
+		std::vector<double> gaps;
+		for (size_t planner = 0; planner < plannerNames.size(); ++planner) {
+			plannerSamples.clear();
+			gaps.clear();
+			for (size_t sample = 0; sample < samples.size(); ++sample) {
+				double makeSpan = planner < makeSpans[sample].size() ? makeSpans[sample][planner] : 0;
+				if (!(makeSpan > 0)) continue;
+				plannerSamples.push_back(samples[sample]);
+				gaps.push_back(makeSpan / best[sample] - 1);
+			}
+			m_trees[planner].fit(plannerSamples, gaps, maxDepth, minLeafSize);
+		}
+	}
+
+	std::vector<size_t> PlannerSelector::rank(const std::vector<double>& features) const
+	{
+		std::vector<double> predicted(m_trees.size());
+		std::vector<size_t> order(m_trees.size());
+		for (size_t planner = 0; planner < m_trees.size(); ++planner) {
+			// planners without a single training row go last
+			predicted[planner] = m_trees[planner].nodes().empty() ? std::numeric_limits<double>::max() : m_trees[planner].predict(features);
+			order[planner] = planner;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return predicted[a] < predicted[b]; });
+		return order;
+	}
+
+	std::vector<PlannerConfig> PlannerSelector::select(const JobContainer& instance, const std::vector<PlannerConfig>& configs, size_t k) const
+	{
+		// every config would count as unknown and be kept, which silently runs the full portfolio
+		if (empty()) throw std::runtime_error("PlannerSelector: select on an untrained model");
+		std::vector<size_t> order = rank(instanceFeatures(instance));
+		order.resize(std::min(order.size(), k));
+		std::vector<PlannerConfig> selected;
+		for (const PlannerConfig& config : configs) {
+			auto known = std::find(m_plannerNames.begin(), m_plannerNames.end(), config.name);
+			bool keep = known == m_plannerNames.end() ||
+				std::find(order.begin(), order.end(), (size_t)(known - m_plannerNames.begin())) != order.end();
+			if (keep) selected.push_back(config);
+		}
+		return selected;
+	}
+
+	void PlannerSelector::save(std::ostream& os) const
+	{
+		const auto& featureNames = InstanceFeatures::names();
+		os << "PlannerSelector 1\n" << m_trees.size() << "\n" << std::setprecision(17);
+		for (size_t planner = 0; planner < m_trees.size(); ++planner) {
+			const std::vector<RegressionTree::Node>& nodes = m_trees[planner].nodes();
+			os << std::quoted(m_plannerNames[planner]) << " " << nodes.size() << "\n";
+			for (const RegressionTree::Node& node : nodes) {
+				os << std::quoted(node.feature == -1 ? std::string() : featureNames[node.feature]) << " "
+					<< node.threshold << " " << node.left << " " << node.right << " " << node.value << "\n";
+			}
+		}
+	}
+
+	void PlannerSelector::load(std::istream& is)
+	{
+		const auto& featureNames = InstanceFeatures::names();
+		std::string header;
+		int version = 0;
+		size_t plannerCount = 0;
+		if (!(is >> header >> version >> plannerCount) || header != "PlannerSelector" || version != 1) {
+			throw std::runtime_error("PlannerSelector: not a selector model");
+		}
+
+		std::vector<std::string> plannerNames(plannerCount);
+		std::vector<RegressionTree> trees(plannerCount);
+		for (size_t planner = 0; planner < plannerCount; ++planner) {
+			size_t nodeCount = 0;
+			if (!(is >> std::quoted(plannerNames[planner]) >> nodeCount)) {
+				throw std::runtime_error("PlannerSelector: truncated model");
+			}
+			std::vector<RegressionTree::Node>& nodes = trees[planner].nodes();
+			nodes.resize(nodeCount);
+			for (size_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+				RegressionTree::Node& node = nodes[nodeIndex];
+				std::string feature;
+				if (!(is >> std::quoted(feature) >> node.threshold >> node.left >> node.right >> node.value)) {
+					throw std::runtime_error("PlannerSelector: truncated model");
+				}
+				node.feature = -1;
+				if (!feature.empty()) {
+					auto it = std::find(featureNames.begin(), featureNames.end(), feature);
+					if (it == featureNames.end()) throw std::runtime_error("PlannerSelector: unknown feature " + feature);
+					node.feature = (int)(it - featureNames.begin());
+				}
+				// children always follow their parent, which also rules out cycles
+				bool validChildren = node.feature == -1 ||
+					((size_t)node.left > nodeIndex && (size_t)node.right > nodeIndex && (size_t)node.left < nodeCount && (size_t)node.right < nodeCount);
+				if (!validChildren) throw std::runtime_error("PlannerSelector: broken tree for " + plannerNames[planner]);
+			}
+		}
+		m_plannerNames = plannerNames;
+		m_trees = trees;
+	}
+
+	bool PlannerSelector::save(const std::string& path) const
+	{
+		std::ofstream ofs(path);
+		if (!ofs) return false;
+		save(ofs);
+		return (bool)ofs;
+	}
+
+	bool PlannerSelector::load(const std::string& path)
+	{
+		std::ifstream ifs(path);
+		if (!ifs) return false;
+		load(ifs);
+		return true;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Portfolio.h"
+#include "FeatureExtractor.h"
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace ConstructionAlgorithm {
+	/* FeatureExtractor features as a plain vector, in InstanceFeatures::names() order */
+	std::vector<double> instanceFeatures(const JobContainer& jobContainer);
+
+	/* Small CART regression tree (squared error) */
+	class RegressionTree {
+	public:
+		struct Node {
+			int feature = -1;		// -1 -> leaf
+			double threshold = 0;	// x[feature] <= threshold goes left
+			int left = -1;
+			int right = -1;
+			double value = 0;
+		};
+
+		void fit(const std::vector<std::vector<double>>& samples, const std::vector<double>& targets,
+			int maxDepth = 4, size_t minLeafSize = 3);
+		double predict(const std::vector<double>& features) const;
+
+		std::vector<Node>& nodes() { return m_nodes; }
+		const std::vector<Node>& nodes() const { return m_nodes; }
+
+	private:
+		int grow(const std::vector<std::vector<double>>& samples, const std::vector<double>& targets,
+			std::vector<size_t>& indices, size_t begin, size_t end, int depth, int maxDepth, size_t minLeafSize);
+
+		std::vector<Node> m_nodes;
+	};
+
+	/* One tree per planner predicting its relative gap to the best planner on the instance
+	   (makespan / best - 1). Only the top predicted planners are run afterwards. */
+	class PlannerSelector {
+	public:
+		/* makeSpans[sample][planner], NaN or <= 0 for "not run" */
+		void train(const std::vector<std::string>& plannerNames, const std::vector<std::vector<double>>& samples,
+			const std::vector<std::vector<double>>& makeSpans, int maxDepth = 4, size_t minLeafSize = 3);
+
+		/* planner indices, lowest predicted gap first (ties by index) */
+		std::vector<size_t> rank(const std::vector<double>& features) const;
+		/* configs whose name is among the k best predicted; configs unknown to the model are kept.
+		   Throws on an untrained (empty) model */
+		std::vector<PlannerConfig> select(const JobContainer& instance, const std::vector<PlannerConfig>& configs, size_t k) const;
+
+		/* Text format, trees refer to features and planners by name so an older model still loads
+		   as long as the features it uses exist */
+		void save(std::ostream& os) const;
+		void load(std::istream& is);
+		bool save(const std::string& path) const;
+		bool load(const std::string& path);
+
+		const std::vector<std::string>& plannerNames() const { return m_plannerNames; }
+		bool empty() const { return m_trees.empty(); }
+
+	private:
+		std::vector<std::string> m_plannerNames;
+		std::vector<RegressionTree> m_trees;
+	};
+}
@@ -0,0 +1,176 @@
+#include "SlackEngine.h"
+
+namespace fjss {
+	SlackEngine::SlackEngine()
+	{
+		m_jobContainer = nullptr;
+		m_restartStamp = 0;
+		m_makeSpan = 0;
+	}
+
+	void SlackEngine::sync(const JobContainer& jobContainer, const Schedule& schedule)
+	{
+		if (m_jobContainer != &jobContainer || m_restartStamp != jobContainer.restartStamp()) {
+			build(jobContainer);
+		}
+		m_makeSpan = schedule.makeSpan();
+
+		// jobs that progressed (or were undone) since the last sync
+		size_t jobIndex = 0;
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			uint64_t version = jobIT.second.version();
+			if (version != m_jobs[jobIndex].version) {
+				m_jobs[jobIndex].version = version;
+				m_dirty[jobIndex] = true;
+			}
+			++jobIndex;
+		}
+		// jobs waiting on stations whose availability changed
+		size_t stationCount = std::min((size_t)schedule.stationCount(), m_stationTime.size());
+		for (StationID stationID = 0; stationID < stationCount; ++stationID) {
+			int time = schedule.getStationAvabilityTime(stationID);
+			if (time == m_stationTime[stationID]) continue;
+			m_stationTime[stationID] = time;
+			for (size_t i = m_stationJobsBegin[stationID]; i < m_stationJobsBegin[stationID + 1]; ++i) {
+				m_dirty[m_stationJobs[i]] = true;
+			}
+		}
+
+		for (jobIndex = 0; jobIndex < m_jobs.size(); ++jobIndex) {
+			if (!m_dirty[jobIndex]) continue;
+			forwardPass(jobIndex);
+			m_dirty[jobIndex] = false;
+		}
+	}
+
+	int SlackEngine::earliestStart(JobID jobID, OperationID operationID) const
+	{
+		return m_earliestStart[index(jobID, operationID)];
+	}
+
+	int SlackEngine::latestFinish(JobID jobID, OperationID operationID) const
+	{
+		return m_makeSpan - m_tail[index(jobID, operationID)];
+	}
+
+	int SlackEngine::slack(JobID jobID, OperationID operationID) const
+	{
+		size_t i = index(jobID, operationID);
+		return m_makeSpan - m_tail[i] - m_earliestStart[i] - m_shortestTime[i];
+	}
+
+	void SlackEngine::build(const JobContainer& jobContainer)
+	{
+		m_jobContainer = &jobContainer;
+		m_restartStamp = jobContainer.restartStamp();
+
+		m_jobIndex.clear();
+		m_jobs.clear();
+		m_operations.clear();
+		m_topologicalOrder.clear();
+		m_shortestTime.clear();
+		m_shortestStation.clear();
+		m_tail.clear();
+
+		size_t stationSlots = jobContainer.getStationDemands().size();
+		std::vector<std::vector<size_t>> stationJobs(stationSlots);
+
+		for (const auto& jobIT : jobContainer.getJobs()) {
+			const Job& job = jobIT.second;
+			if (m_jobIndex.size() <= job.jobID) m_jobIndex.resize(job.jobID + 1, 0);
+			m_jobIndex[job.jobID] = m_jobs.size();
+
+			JobSlot slot;
+			slot.offset = m_operations.size();
+			slot.operationCount = job.getOperaions().size();
+			slot.version = std::numeric_limits<uint64_t>::max();
+
+			size_t localIndex = 0;
+			for (const auto& operationIT : job.getOperaions()) {
+				if (operationIT.first != localIndex++) {
+					throw std::runtime_error("SlackEngine: operation ids must be 0..n-1 within a job");
+				}
+				const Operation& operation = operationIT.second;
+				int shortestTime = operation.getShortestProcessTime();
+				StationID shortestStation = 0;
+				for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+					if (ots.time == shortestTime) {
+						shortestStation = ots.stationID;
+						break;
+					}
+				}
+				m_operations.push_back(&operation);
+				m_shortestTime.push_back(shortestTime);
+				m_shortestStation.push_back(shortestStation);
+				if (shortestStation < stationSlots &&
+					(stationJobs[shortestStation].empty() || stationJobs[shortestStation].back() != m_jobs.size())) {
+					stationJobs[shortestStation].push_back(m_jobs.size());
+				}
+			}
+
+			// topological order by predecessor counting
+			std::vector<int> predecessorCount(slot.operationCount);
+			for (size_t i = 0; i < slot.operationCount; ++i) {
+				predecessorCount[i] = m_operations[slot.offset + i]->getPredecessors().size();
+				if (predecessorCount[i] == 0) m_topologicalOrder.push_back(i);
+			}
+			for (size_t head = slot.offset; head < m_topologicalOrder.size(); ++head) {
+				for (OperationID successorID : job.getSuccessors(m_topologicalOrder[head])) {
+					if (--predecessorCount[successorID] == 0) m_topologicalOrder.push_back(successorID);
+				}
+			}
+			if (m_topologicalOrder.size() != slot.offset + slot.operationCount) {
+				throw std::runtime_error("SlackEngine: precedence cycle in job " + std::to_string(job.jobID));
+			}
+
+			// backward pass, tails never change for a given problem
+			m_tail.resize(m_operations.size(), 0);
+			for (size_t k = slot.operationCount; k-- > 0;) {
+				size_t operationIndex = m_topologicalOrder[slot.offset + k];
+				int tail = 0;
+				for (OperationID successorID : job.getSuccessors(operationIndex)) {
+					tail = std::max(tail, m_tail[slot.offset + successorID] + m_shortestTime[slot.offset + successorID]);
+				}
+				m_tail[slot.offset + operationIndex] = tail;
+			}
+			m_jobs.push_back(slot);
+		}
+
+		m_earliestStart.assign(m_operations.size(), 0);
+		m_dirty.assign(m_jobs.size(), true);
+		m_stationTime.assign(stationSlots, -1);
+		m_stationJobsBegin.assign(stationSlots + 1, 0);
+		m_stationJobs.clear();
+		for (size_t stationID = 0; stationID < stationSlots; ++stationID) {
+			m_stationJobsBegin[stationID] = m_stationJobs.size();
+			m_stationJobs.insert(m_stationJobs.end(), stationJobs[stationID].begin(), stationJobs[stationID].end());
+		}
+		m_stationJobsBegin[stationSlots] = m_stationJobs.size();
+	}
+
+	void SlackEngine::forwardPass(size_t jobIndex)
+	{
+		const JobSlot& slot = m_jobs[jobIndex];
+		for (size_t k = 0; k < slot.operationCount; ++k) {
+			size_t i = slot.offset + m_topologicalOrder[slot.offset + k];
+			const Operation& operation = *m_operations[i];
+			if (operation.isDone()) continue;
+
+			int earliestStart = operation.getLastPrecedessorTime();
+			for (OperationID predecessorID : operation.getPredecessors()) {
+				size_t p = slot.offset + predecessorID;
+				if (m_operations[p]->isDone()) continue;
+				earliestStart = std::max(earliestStart, m_earliestStart[p] + m_shortestTime[p]);
+			}
+			if (m_shortestStation[i] < m_stationTime.size()) {
+				earliestStart = std::max(earliestStart, m_stationTime[m_shortestStation[i]]);
+			}
+			m_earliestStart[i] = earliestStart;
+		}
+	}
+
+	size_t SlackEngine::index(JobID jobID, OperationID operationID) const
+	{
+		return m_jobs[m_jobIndex[jobID]].offset + operationID;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "FJSS.hpp"
+
+namespace fjss {
+	/* Earliest start / latest finish times of all not done operations.
+	   LF only depends on job structure, so tails are computed once by a backward pass per job;
+	   ES is refreshed by a forward pass only for jobs that progressed or whose
+	   shortest-time stations became available later since the last sync. */
+	class SlackEngine {
+	public:
+		SlackEngine();
+		void sync(const JobContainer& jobContainer, const Schedule& schedule);
+
+		int earliestStart(JobID jobID, OperationID operationID) const;
+		int latestFinish(JobID jobID, OperationID operationID) const;
+		/* LF - ES - shortest process time */
+		int slack(JobID jobID, OperationID operationID) const;
+
+	private:
+		void build(const JobContainer& jobContainer);
+		void forwardPass(size_t jobIndex);
+		size_t index(JobID jobID, OperationID operationID) const;
+
+		struct JobSlot {
+			size_t offset;
+			size_t operationCount;
+			uint64_t version;
+		};
+
+		const JobContainer* m_jobContainer;
+		uint64_t m_restartStamp;
+		int m_makeSpan;
+
+		std::vector<size_t> m_jobIndex;			// jobID -> slot
+		std::vector<JobSlot> m_jobs;
+		std::vector<bool> m_dirty;
+
+		// per operation, flattened by job offset
+		std::vector<const Operation*> m_operations;
+		std::vector<size_t> m_topologicalOrder;	// local operation indices
+		std::vector<int> m_shortestTime;
+		std::vector<StationID> m_shortestStation;
+		std::vector<int> m_tail;				// longest shortest-time path after operation
+		std::vector<int> m_earliestStart;
+
+		// station -> jobs with an operation whose shortest-time station it is
+		std::vector<int> m_stationTime;
+		std::vector<size_t> m_stationJobsBegin;
+		std::vector<size_t> m_stationJobs;
+	};
+}
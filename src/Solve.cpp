@@ -0,0 +1,112 @@
+#include "Solve.h"
+#include "TabuSearch.h"
+#include <chrono>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		using Clock = std::chrono::steady_clock;
+
+		/* every job's availible operations in turn, each on its earliest end station */
+		void completeGreedily(JobContainer& jobContainer, Schedule& schedule)
+		{
+			std::vector<OperationID> availible;
+			while (!jobContainer.isDone()) {
+				for (auto& jobIT : jobContainer.getJobs()) {
+					Job& job = jobIT.second;
+					availible = job.getAvailibleOperations();
+					for (OperationID operationID : availible) {
+						const Operation& operation = job.getOperation(operationID);
+						StationID bestStation = 0;
+						int bestEnd = std::numeric_limits<int>::max();
+						for (const OperationTimeStation& ots : operation.getOperationTimeStations()) {
+							int end = schedule.fastestEndTimeForScheduleOperation(ots.stationID, operationID, job.jobID, jobContainer);
+							if (end < bestEnd) {
+								bestEnd = end;
+								bestStation = ots.stationID;
+							}
+						}
+						schedule.stackScheduleOperation(bestStation, operationID, job.jobID, jobContainer);
+					}
+				}
+			}
+		}
+	}
+
+	SolveResult solve(const JobContainer& instance, const SolveBudget& budget, const SolveCallbacks& callbacks, const SolveOptions& options)
+	{
+		SolveResult result;
+		Clock::time_point start = Clock::now();
+		auto seconds = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+		auto cancelled = [&]() { return budget.cancellation && budget.cancellation->isCancelled(); };
+		auto expired = [&]() {
+			return cancelled() || (budget.timeLimit > 0.0 && seconds() >= budget.timeLimit) ||
+				(budget.iterations != 0 && result.iterations >= budget.iterations);
+		};
+		auto report = [&](const Schedule& schedule, const char* phase) {
+			result.bestSchedule = schedule;
+			result.bestMakeSpan = schedule.makeSpan();
+			if (callbacks.onIncumbent) callbacks.onIncumbent(Incumbent{ result.bestSchedule, result.bestMakeSpan, seconds(), phase });
+		};
+
+		// construction, cut short by the budget
+		PlannerConfig callerSettings = threadSettings();
+		PlannerConfig construction = options.construction;
+		if (!construction.planner) {
+			construction = callerSettings;
+			construction.name = "CP_HF_Planner";
+			construction.planner = CP_HF_Planner;
+		}
+		construction.apply();
+		JobContainer jobContainer = instance;
+		Schedule schedule(instance.stationCount());
+		ConstructionSolver solver(jobContainer, schedule, construction.planner);
+		while (!jobContainer.isDone()) {
+			if (cancelled() || (budget.timeLimit > 0.0 && seconds() >= budget.timeLimit)) {
+				completeGreedily(jobContainer, schedule);
+				result.constructionCut = true;
+				break;
+			}
+			solver.next();
+		}
+		callerSettings.apply();
+		report(schedule, result.constructionCut ? "completion" : "construction");
+
+		// no schedule beats the bound, so reaching it ends the improvement
+		jobContainer.restartContainer();
+		result.lowerBound = std::max(loadLowerBound(jobContainer, Schedule(instance.stationCount())), jobLowerBound(jobContainer));
+
+		// improvement in single steps, restarted from the best schedule when a search stops
+		SearchFactory factory = options.improvement;
+		if (!factory) {
+			factory = [&instance](const Schedule& from, uint64_t seed) {
+				TabuOptions tabu;
+				tabu.iterations = std::numeric_limits<size_t>::max();
+				tabu.seed = seed;
+				return std::unique_ptr<ImprovementSearch>(new TabuSearch(instance, from, tabu));
+			};
+		}
+		bool bounded = budget.timeLimit > 0.0 || budget.iterations != 0 || budget.cancellation;
+		while (result.bestMakeSpan > result.lowerBound && !expired()) {
+			std::unique_ptr<ImprovementSearch> search = factory(result.bestSchedule, Xoshiro256::stream(options.seed, result.searches)());
+			++result.searches;
+			bool running = true, improved = false;
+			size_t steps = 0;
+			while (running && !expired() && result.bestMakeSpan > result.lowerBound) {
+				running = search->run(1);
+				++result.iterations;
+				++steps;
+				if (search->bestMakeSpan() < result.bestMakeSpan) {
+					report(search->bestSchedule(), "improvement");
+					improved = true;
+				}
+			}
+			// a search with nothing to do from the best schedule would be rebuilt the same way forever
+			bool stalled = !running && steps == 1 && !improved;
+			if (!bounded || stalled) break;
+		}
+
+		result.status = cancelled() ? SolveStatus::Cancelled : SolveStatus::Completed;
+		result.seconds = seconds();
+		return result;
+	}
+}
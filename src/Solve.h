@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Portfolio.h"
+#include "ImprovementSearch.h"
+#include <memory>
+
+namespace ConstructionAlgorithm {
+	struct SolveBudget {
+		double timeLimit = 0.0;		// wall-clock seconds from the call, 0 -> none
+		size_t iterations = 0;		// improvement steps, 0 -> none
+		std::optional<CancellationToken> cancellation;
+	};
+
+	/* A new best schedule; the reference is only valid during the callback */
+	struct Incumbent {
+		const Schedule& schedule;
+		int makeSpan;
+		double seconds;				// since the call
+		const char* phase;			// "construction", "completion" or "improvement"
+	};
+
+	struct SolveCallbacks {
+		std::function<void(const Incumbent& incumbent)> onIncumbent;
+	};
+
+	/* improvement search continuing from the best schedule so far */
+	using SearchFactory = std::function<std::unique_ptr<ImprovementSearch>(const Schedule& start, uint64_t seed)>;
+
+	struct SolveOptions {
+		PlannerConfig construction;	// empty planner -> CP_HF with the calling thread's settings
+		SearchFactory improvement;	// empty -> TabuSearch with default TabuOptions and no iteration cap
+		uint64_t seed = 1;
+	};
+
+	struct SolveResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		SolveStatus status = SolveStatus::Completed;	// Cancelled when the token fired
+		bool constructionCut = false;	// the budget ran out during construction
+		size_t iterations = 0;
+		size_t searches = 0;			// improvement searches started
+		int lowerBound = 0;				// max of loadLowerBound and jobLowerBound of the instance
+		double seconds = 0.0;
+	};
+
+	/* Anytime entry point: construction, then improvement until the budget runs out, reporting every
+	   new best schedule. The budget and the token are checked before every construction step and every
+	   improvement step, the cheap points of both loops. If they fire during construction the partial
+	   schedule is finished in linear time (every job's availible operations in turn, each at its
+	   earliest end), so there is always a complete schedule and the overrun past the deadline is bounded
+	   by that pass. A search that stops on its own is replaced by a new one from the best schedule with
+	   the next seed, unless it stopped on its first step without improving (the replacement would do the
+	   same); with neither a time limit, an iteration budget nor a token only one search runs. Improvement
+	   ends early when the best makespan reaches SolveResult::lowerBound, which proves it optimal.
+	   Everything runs on the calling thread, the callbacks too. */
+	SolveResult solve(const JobContainer& instance, const SolveBudget& budget, const SolveCallbacks& callbacks = SolveCallbacks(),
+		const SolveOptions& options = SolveOptions());
+}
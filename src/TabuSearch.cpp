@@ -0,0 +1,303 @@
+#include "TabuSearch.h"
+#include "ReassignmentEvaluator.h"
+#include <unordered_map>
+#include <algorithm>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		struct Move {
+			int node;
+			StationID station;
+			size_t position;		// in the target sequence without the node
+			int predecessor;		// station predecessor the node gets, -1 for none
+			int estimate;
+		};
+
+		/* Longest paths through a critical block after moving one end of it, from heads and tails only.
+		   The rest of the block is shifted by one, its heads (tails) are a prefix (suffix) chain shared
+		   by every target position, so a position costs O(1) plus the nodes on the other side of the
+		   moved operation whose heads (tails) actually change. */
+		struct BlockEstimator {
+			std::vector<int> chain;		// shifted heads (front moves) or tails (back moves), by block index
+			std::vector<int> best;		// running max of the paths leaving the chain through job arcs
+
+			/* block[0] behind block[j] for every j, estimates[j - 1] */
+			void frontMoves(const DisjunctiveGraph& graph, const std::vector<int>& block, std::vector<int>& estimates)
+			{
+				size_t length = block.size();
+				chain.assign(length, 0);
+				best.assign(length, 0);
+				int previous = graph.stationPredecessor(block.front());
+				int previousEnd = previous == -1 ? 0 : graph.end(previous);
+				for (size_t k = 1; k < length; ++k) {
+					chain[k] = std::max(graph.jobReady(block[k]), previousEnd);
+					previousEnd = chain[k] + graph.time(block[k]);
+					best[k] = std::max(k > 1 ? best[k - 1] : 0, previousEnd + graph.jobTail(block[k]));
+				}
+
+				int u = block.front();
+				int after = graph.stationSuccessor(block.back());
+				estimates.clear();
+				for (size_t j = 1; j < length; ++j) {
+					int next = j + 1 < length ? block[j + 1] : after;
+					int head = std::max(graph.jobReady(u), chain[j] + graph.time(block[j]));
+					int tail = std::max(graph.jobTail(u), next == -1 ? 0 : graph.time(next) + graph.tail(next));
+					int estimate = std::max(best[j], head + graph.time(u) + tail);
+					// rest of the block starts after u, until a head doesn't move
+					int end = head + graph.time(u);
+					for (size_t k = j + 1; k < length; ++k) {
+						int w = block[k];
+						int wHead = std::max(graph.jobReady(w), end);
+						estimate = std::max(estimate, wHead + graph.time(w) + graph.tail(w));
+						if (wHead == graph.head(w)) break;
+						end = wHead + graph.time(w);
+					}
+					estimates.push_back(estimate);
+				}
+			}
+
+			/* block[L - 1] in front of block[j] for every j, estimates[j] */
+			void backMoves(const DisjunctiveGraph& graph, const std::vector<int>& block, std::vector<int>& estimates)
+			{
+				size_t length = block.size();
+				chain.assign(length, 0);
+				best.assign(length, 0);
+				int next = graph.stationSuccessor(block.back());
+				int nextTail = next == -1 ? 0 : graph.time(next) + graph.tail(next);
+				for (size_t k = length - 1; k-- > 0;) {
+					chain[k] = std::max(graph.jobTail(block[k]), nextTail);
+					nextTail = graph.time(block[k]) + chain[k];
+					best[k] = std::max(k + 2 < length ? best[k + 1] : 0, graph.jobReady(block[k]) + nextTail);
+				}
+
+				int v = block.back();
+				int before = graph.stationPredecessor(block.front());
+				estimates.assign(length - 1, 0);
+				for (size_t j = length - 1; j-- > 0;) {
+					int previous = j > 0 ? block[j - 1] : before;
+					int head = std::max(graph.jobReady(v), previous == -1 ? 0 : graph.end(previous));
+					int tail = std::max(graph.jobTail(v), graph.time(block[j]) + chain[j]);
+					int estimate = std::max(best[j], head + graph.time(v) + tail);
+					// front of the block now leads into v, until a tail doesn't move
+					int lead = graph.time(v) + tail;
+					for (size_t k = j; k-- > 0;) {
+						int w = block[k];
+						int wTail = std::max(graph.jobTail(w), lead);
+						estimate = std::max(estimate, graph.head(w) + graph.time(w) + wTail);
+						if (wTail == graph.tail(w)) break;
+						lead = graph.time(w) + wTail;
+					}
+					estimates[j] = estimate;
+				}
+			}
+		};
+	}
+
+	struct TabuSearch::State {
+		const JobContainer& instance;
+		TabuOptions options;
+		DisjunctiveGraph graph;
+		DisjunctiveGraph best;
+		TabuResult result;		// bestSchedule is only built on request
+		Xoshiro256 rng;
+		uint64_t nodeCount;
+		uint64_t stationCount;
+		std::unordered_map<uint64_t, size_t> tabuUntil;
+
+		std::vector<int> path, estimates;
+		BlockEstimator blockEstimator;
+		ReassignmentEvaluator reassignmentEvaluator;
+		ReassignmentEvaluator::Insertion insertion;
+		std::vector<std::vector<int>> blocks;
+		std::vector<Move> moves;
+		std::vector<const Move*> candidates;
+		size_t candidateCount;
+		size_t iteration = 0;
+		size_t sinceImprovement = 0;
+		bool exhausted = false;		// no move left
+
+		State(const JobContainer& instance, const Schedule& initial, const TabuOptions& options)
+			: instance(instance), options(options), graph(instance, initial), rng(options.seed)
+		{
+			best = graph;
+			result.bestMakeSpan = graph.makeSpan();
+			nodeCount = graph.nodeCount();
+			stationCount = std::max<size_t>(graph.stationCount(), 1);
+			candidateCount = std::max<size_t>(options.exactCandidates, 1);
+			exhausted = nodeCount == 0;
+		}
+
+		uint64_t tabuKey(int node, StationID station, int predecessor) const
+		{
+			return ((uint64_t)node * (nodeCount + 1) + (uint64_t)(predecessor + 1)) * stationCount + station;
+		}
+
+		bool running() const
+		{
+			return !exhausted && iteration < options.iterations && sinceImprovement < options.maxNoImprove;
+		}
+
+		/* one move, false when the neighbourhood is empty */
+		bool step();
+	};
+
+	bool TabuSearch::State::step()
+	{
+		result.iterations = iteration + 1;
+		graph.criticalPath(path);
+		graph.criticalBlocks(path, blocks);
+		moves.clear();
+		reassignmentEvaluator.invalidate();
+
+		for (const std::vector<int>& block : blocks) {
+			if (block.size() < 2) continue;
+			StationID station = graph.station(block.front());
+			size_t first = graph.position(block.front());
+
+			// first operation behind block[j]
+			int u = block.front();
+			blockEstimator.frontMoves(graph, block, estimates);
+			for (size_t j = 1; j < block.size(); ++j) {
+				if (!graph.canMoveBehind(u, block[j])) break;
+				moves.push_back({ u, station, first + j, block[j], estimates[j - 1] });
+			}
+			// last operation in front of block[j], the adjacent swap was already covered for two element blocks
+			if (block.size() == 2) continue;
+			int v = block.back();
+			blockEstimator.backMoves(graph, block, estimates);
+			for (size_t j = block.size() - 1; j-- > 0;) {
+				if (!graph.canMoveBefore(v, block[j])) break;
+				int predecessor = j > 0 ? block[j - 1] : graph.stationPredecessor(block.front());
+				moves.push_back({ v, station, first + j, predecessor, estimates[j] });
+			}
+		}
+
+		if (options.reassignment) {
+			for (int u : path) {
+				for (const OperationTimeStation* ots = graph.alternativesBegin(u); ots != graph.alternativesEnd(u); ++ots) {
+					if (ots->stationID == graph.station(u)) continue;
+					if (reassignmentEvaluator.bestInsertion(graph, u, ots->stationID, ots->time, insertion)) {
+						moves.push_back({ u, ots->stationID, insertion.position, insertion.predecessor, insertion.estimate });
+					}
+				}
+			}
+		}
+		if (moves.empty()) return false;
+
+		// best allowed moves by estimate, or the best tabu one if everything is tabu
+		const Move* fallback = nullptr;
+		candidates.clear();
+		for (const Move& move : moves) {
+			if (!fallback || move.estimate < fallback->estimate) fallback = &move;
+			if (candidates.size() == candidateCount && move.estimate >= candidates.back()->estimate) continue;
+			auto tabu = tabuUntil.find(tabuKey(move.node, move.station, move.predecessor));
+			bool isTabu = tabu != tabuUntil.end() && tabu->second > iteration;
+			if (isTabu && !(options.aspiration && move.estimate < result.bestMakeSpan)) continue;
+			auto at = std::upper_bound(candidates.begin(), candidates.end(), move.estimate,
+				[](int estimate, const Move* other) { return estimate < other->estimate; });
+			candidates.insert(at, &move);
+			if (candidates.size() > candidateCount) candidates.pop_back();
+		}
+
+		// estimates only see the path through the moved operation, the best few get the real makespan
+		const Move* chosen = candidates.empty() ? fallback : candidates.front();
+		if (candidates.size() > 1) {
+			int chosenMakeSpan = std::numeric_limits<int>::max();
+			for (const Move* move : candidates) {
+				int makeSpan = ReassignmentEvaluator::exactMakeSpan(graph, move->node, move->station, move->position);
+				if (makeSpan != -1 && makeSpan < chosenMakeSpan) {
+					chosen = move;
+					chosenMakeSpan = makeSpan;
+				}
+			}
+		}
+
+		int node = chosen->node;
+		StationID oldStation = graph.station(node);
+		int oldPredecessor = graph.stationPredecessor(node);
+		size_t tenure = options.tenureMin + (options.tenureMax > options.tenureMin ?
+			rng.uniformInt(options.tenureMax - options.tenureMin + 1) : 0);
+		tabuUntil[tabuKey(node, oldStation, oldPredecessor)] = iteration + 1 + tenure;
+
+		if (!graph.applyMove(node, chosen->station, chosen->position)) {
+			// the conditions only rule out cycles on positive times, the graph took the move back
+			tabuUntil[tabuKey(node, chosen->station, chosen->predecessor)] = iteration + 1 + tenure;
+			++sinceImprovement;
+			++iteration;
+			return true;
+		}
+
+		if (graph.makeSpan() < result.bestMakeSpan) {
+			result.bestMakeSpan = graph.makeSpan();
+			best = graph;
+			++result.improvements;
+			sinceImprovement = 0;
+		}
+		else {
+			++sinceImprovement;
+		}
+
+		// keep the map small, expired entries are as good as absent
+		if (tabuUntil.size() > 64 * (options.tenureMax + 1)) {
+			for (auto it = tabuUntil.begin(); it != tabuUntil.end();) {
+				if (it->second <= iteration) it = tabuUntil.erase(it);
+				else ++it;
+			}
+		}
+		++iteration;
+		return true;
+	}
+
+	TabuSearch::TabuSearch(const JobContainer& instance, const Schedule& initial, const TabuOptions& options)
+		: m_state(new State(instance, initial, options))
+	{
+	}
+
+	TabuSearch::~TabuSearch() = default;
+
+	bool TabuSearch::run(size_t iterations)
+	{
+		State& state = *m_state;
+		for (size_t i = 0; i < iterations && state.running(); ++i) {
+			if (!state.step()) state.exhausted = true;
+		}
+		return state.running();
+	}
+
+	int TabuSearch::bestMakeSpan() const
+	{
+		return m_state->result.bestMakeSpan;
+	}
+
+	Schedule TabuSearch::bestSchedule() const
+	{
+		return m_state->best.toSchedule(m_state->instance);
+	}
+
+	void TabuSearch::immigrate(const Schedule& schedule)
+	{
+		State& state = *m_state;
+		state.graph = DisjunctiveGraph(state.instance, schedule);
+		if (state.graph.makeSpan() < state.result.bestMakeSpan) {
+			state.result.bestMakeSpan = state.graph.makeSpan();
+			state.best = state.graph;
+			++state.result.improvements;
+		}
+		state.sinceImprovement = 0;
+		state.exhausted = state.nodeCount == 0;
+	}
+
+	TabuResult TabuSearch::result() const
+	{
+		TabuResult result = m_state->result;
+		result.bestSchedule = bestSchedule();
+		return result;
+	}
+
+	TabuResult tabuSearch(const JobContainer& instance, const Schedule& initial, const TabuOptions& options)
+	{
+		TabuSearch search(instance, initial, options);
+		search.run(options.iterations);
+		return search.result();
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "DisjunctiveGraph.h"
+#include "ImprovementSearch.h"
+#include <memory>
+
+namespace ConstructionAlgorithm {
+	struct TabuOptions {
+		size_t iterations = 10000;
+		size_t maxNoImprove = 2000;		// stop after this many iterations without a new best
+		/* a moved operation may not get its old (station, station predecessor) back for a tenure drawn
+		   from [tenureMin, tenureMax] each move */
+		size_t tenureMin = 5;
+		size_t tenureMax = 15;
+		bool aspiration = true;			// tabu moves are allowed when their estimate beats the best makespan
+		bool reassignment = true;		// move critical operations to other eligible stations too
+		size_t exactCandidates = 3;		// best allowed moves by estimate that are applied and measured before choosing
+		uint64_t seed = 1;
+	};
+
+	struct TabuResult {
+		Schedule bestSchedule = Schedule(0);
+		int bestMakeSpan = std::numeric_limits<int>::max();
+		size_t iterations = 0;
+		size_t improvements = 0;
+	};
+
+	/* Tabu search on the disjunctive graph of a finished schedule.
+	   Neighbourhood: the first operation of a critical block moved behind any other operation of the block,
+	   the last one moved in front of any other (adjacent swaps included), and with reassignment every
+	   critical operation moved to each other eligible station at its best feasible position.
+	   Moves are rated from heads and tails without touching the graph (reassignments through
+	   ReassignmentEvaluator), only the best few are applied and measured, with the graph updating heads
+	   and tails where they change. Moves that could close a cycle are left out using the usual head/tail
+	   conditions. */
+	class TabuSearch : public ImprovementSearch {
+	public:
+		/* the instance is kept by reference and must outlive the search */
+		TabuSearch(const JobContainer& instance, const Schedule& initial, const TabuOptions& options = TabuOptions());
+		~TabuSearch() override;
+
+		/* options.iterations and maxNoImprove count over all runs */
+		bool run(size_t iterations) override;
+		int bestMakeSpan() const override;
+		Schedule bestSchedule() const override;
+		/* the search continues from the schedule, the tabu list is kept */
+		void immigrate(const Schedule& schedule) override;
+
+		TabuResult result() const;
+
+	private:
+		struct State;
+		std::unique_ptr<State> m_state;
+	};
+
+	/* TabuSearch run until it stops */
+	TabuResult tabuSearch(const JobContainer& instance, const Schedule& initial, const TabuOptions& options = TabuOptions());
+}
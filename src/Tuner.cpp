@@ -0,0 +1,338 @@
+#include "Tuner.h"
+#include "Parallel.hpp"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace ConstructionAlgorithm {
+	namespace {
+		using Matrix = std::vector<std::vector<double>>;
+
+		/* Jacobi rotations, fine for the few params a planner has: C = B diag(values) B^T */
+		void eigenDecomposition(Matrix a, Matrix& vectors, std::vector<double>& values)
+		{
+			size_t n = a.size();
+			vectors.assign(n, std::vector<double>(n, 0.0));
+			for (size_t i = 0; i < n; ++i) vectors[i][i] = 1.0;
+			for (int sweep = 0; sweep < 50; ++sweep) {
+				double offDiagonal = 0;
+				for (size_t p = 0; p < n; ++p) {
+					for (size_t q = p + 1; q < n; ++q) offDiagonal += a[p][q] * a[p][q];
+				}
+				if (offDiagonal < 1e-30) break;
+				for (size_t p = 0; p < n; ++p) {
+					for (size_t q = p + 1; q < n; ++q) {
+						if (a[p][q] == 0.0) continue;
+						double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+						double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+						double c = 1 / std::sqrt(t * t + 1);
+						double s = t * c;
+						for (size_t k = 0; k < n; ++k) {
+							double akp = a[k][p], akq = a[k][q];
+							a[k][p] = c * akp - s * akq;
+							a[k][q] = s * akp + c * akq;
+						}
+						for (size_t k = 0; k < n; ++k) {
+							double apk = a[p][k], aqk = a[q][k];
+							a[p][k] = c * apk - s * aqk;
+							a[q][k] = s * apk + c * aqk;
+						}
+						for (size_t k = 0; k < n; ++k) {
+							double vkp = vectors[k][p], vkq = vectors[k][q];
+							vectors[k][p] = c * vkp - s * vkq;
+							vectors[k][q] = s * vkp + c * vkq;
+						}
+					}
+				}
+			}
+			values.resize(n);
+			for (size_t i = 0; i < n; ++i) values[i] = std::max(a[i][i], 1e-20);
+		}
+
+		/* Box-Muller, so samples are the same on every standard library */
+		double standardNormal(Xoshiro256& random)
+		{
+			double u = 1.0 - random.uniformReal();
+			double v = random.uniformReal();
+			return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+		}
+
+		struct EvaluationWorker {
+			std::vector<JobContainer> problems;
+			std::vector<char> copied;
+			Schedule schedule = Schedule(0);
+		};
+
+		/* Runs configs over the training problems, keeping each worker's problem copies between calls */
+		class Evaluator {
+		public:
+			Evaluator(const std::vector<JobContainer>& training, unsigned threadCount, ResultCache* cache)
+				: m_training(training), m_cache(cache), m_pool(threadCount), m_workers(m_pool.workerCount())
+			{
+				if (m_cache) {
+					for (const JobContainer& problem : training) m_hashes.push_back(instanceHash(problem));
+				}
+			}
+
+			/* makeSpans[config][problem] */
+			Matrix evaluate(const std::vector<PlannerConfig>& configs)
+			{
+				size_t problemCount = m_training.size();
+				Matrix makeSpans(configs.size(), std::vector<double>(problemCount, 0.0));
+				m_pool.parallelFor(configs.size() * problemCount, [&](size_t index, unsigned workerIndex) {
+					size_t config = index / problemCount;
+					size_t problem = index % problemCount;
+					makeSpans[config][problem] = run(configs[config], problem, workerIndex);
+				});
+				m_evaluations += configs.size() * problemCount;
+				return makeSpans;
+			}
+
+			/* makespans of configs[alive[i]] on one problem, for RaceOptions::evaluate */
+			std::vector<int> evaluate(const std::vector<PlannerConfig>& configs, const std::vector<size_t>& alive, size_t problem)
+			{
+				std::vector<int> makeSpans(alive.size());
+				m_pool.parallelFor(alive.size(), [&](size_t index, unsigned workerIndex) {
+					makeSpans[index] = run(configs[alive[index]], problem, workerIndex);
+				});
+				m_evaluations += alive.size();
+				return makeSpans;
+			}
+
+			size_t evaluations() const { return m_evaluations; }
+
+		private:
+			int run(const PlannerConfig& config, size_t problem, unsigned workerIndex)
+			{
+				ResultCache::Entry entry;
+				if (m_cache && m_cache->find(m_hashes[problem], config, entry)) return entry.makeSpan;
+				std::unique_ptr<EvaluationWorker>& worker = m_workers[workerIndex];
+				if (!worker) {
+					worker.reset(new EvaluationWorker());
+					worker->problems.resize(m_training.size());
+					worker->copied.assign(m_training.size(), 0);
+				}
+				if (!worker->copied[problem]) {
+					worker->problems[problem] = m_training[problem];
+					worker->copied[problem] = 1;
+				}
+				JobContainer& jobContainer = worker->problems[problem];
+				worker->schedule = Schedule(jobContainer.stationCount());
+				config.apply();
+				ConstructionSolver solver(jobContainer, worker->schedule, config.planner);
+				solver.scheduleAll();
+				int makeSpan = worker->schedule.makeSpan();
+				if (m_cache) m_cache->insert(m_hashes[problem], config, makeSpan);
+				return makeSpan;
+			}
+
+			const std::vector<JobContainer>& m_training;
+			ResultCache* m_cache;
+			std::vector<uint64_t> m_hashes;
+			Parallel::WorkerPool m_pool;
+			std::vector<std::unique_ptr<EvaluationWorker>> m_workers;
+			size_t m_evaluations = 0;
+		};
+
+		double mean(const std::vector<double>& values)
+		{
+			return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+		}
+	}
+
+	std::vector<TuneTarget> tuneTargets()
+	{
+		return {
+			{ "HF2_Planner", HF2_Planner, { 0.0, 0.0, 0.0 } },
+			{ "CP_HF_Planner", CP_HF_Planner, { 0.0, 0.0, 0.0 } },
+			{ "TBOP_HF_Planner", TBOP_HF_Planner, { 0.0, 0.0, 0.0 } },
+			{ "EIT_OT_Planner", EIT_OT_Planner, { 0.0 } },
+		};
+	}
+
+	TuneResult tuneParams(const std::vector<JobContainer>& training, const TuneTarget& target, const TuneOptions& options)
+	{
+		TuneResult result;
+		result.name = target.name;
+		result.params = target.initial;
+		size_t n = target.initial.size();
+		if (n == 0 || training.empty()) return result;
+
+		auto start = std::chrono::steady_clock::now();
+		PlannerConfig callerSettings = threadSettings();
+		auto candidateConfig = [&](const std::vector<double>& params) {
+			PlannerConfig config = callerSettings;
+			config.name = target.name;
+			config.planner = target.planner;
+			config.params = params;
+			return config;
+		};
+
+		// strategy parameters, Hansen's defaults
+		size_t lambda = options.populationSize > 0 ? std::max<size_t>(options.populationSize, 2) : 4 + (size_t)(3 * std::log((double)n));
+		size_t mu = lambda / 2;
+		std::vector<double> weights(mu);
+		for (size_t i = 0; i < mu; ++i) weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+		double weightSum = std::accumulate(weights.begin(), weights.end(), 0.0);
+		for (double& weight : weights) weight /= weightSum;
+		double squaredWeightSum = 0;
+		for (double weight : weights) squaredWeightSum += weight * weight;
+		double muEff = 1.0 / squaredWeightSum;
+		double cc = (4 + muEff / n) / (n + 4 + 2 * muEff / n);
+		double cs = (muEff + 2) / (n + muEff + 5);
+		double c1 = 2 / ((n + 1.3) * (n + 1.3) + muEff);
+		double cmu = std::min(1 - c1, 2 * (muEff - 2 + 1 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+		double damps = 1 + 2 * std::max(0.0, std::sqrt((muEff - 1) / (n + 1)) - 1) + cs;
+		double chiN = std::sqrt((double)n) * (1 - 1.0 / (4 * n) + 1.0 / (21.0 * n * n));
+
+		std::vector<double> mean = target.initial;
+		double sigma = target.sigma;
+		Matrix C(n, std::vector<double>(n, 0.0)), B;
+		for (size_t i = 0; i < n; ++i) C[i][i] = 1.0;
+		std::vector<double> D, pc(n, 0.0), ps(n, 0.0);
+
+		Evaluator evaluator(training, options.threadCount, options.cache);
+		result.initialMeanMakeSpan = result.meanMakeSpan = ConstructionAlgorithm::mean(evaluator.evaluate({ candidateConfig(mean) })[0]);
+
+		Matrix x(lambda, std::vector<double>(n)), y(lambda, std::vector<double>(n));
+		std::vector<double> z(n), meanStep(n), whitened(n);
+		std::vector<PlannerConfig> configs;
+		std::vector<size_t> order(lambda);
+		for (size_t generation = 0; generation < options.generations; ++generation) {
+			if (options.timeLimit > 0.0 &&
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= options.timeLimit) break;
+			eigenDecomposition(C, B, D);
+			double longestAxis = std::sqrt(*std::max_element(D.begin(), D.end()));
+			if (sigma * longestAxis < options.tolerance) break;
+
+			// x_k = m + sigma B D z_k
+			Xoshiro256 random = Xoshiro256::stream(options.seed, generation);
+			configs.clear();
+			for (size_t k = 0; k < lambda; ++k) {
+				for (size_t i = 0; i < n; ++i) z[i] = standardNormal(random) * std::sqrt(D[i]);
+				for (size_t i = 0; i < n; ++i) {
+					y[k][i] = 0;
+					for (size_t j = 0; j < n; ++j) y[k][i] += B[i][j] * z[j];
+					x[k][i] = mean[i] + sigma * y[k][i];
+				}
+				configs.push_back(candidateConfig(x[k]));
+			}
+
+			// rank the candidates, best first; only ones that ran every problem can become the best
+			std::iota(order.begin(), order.end(), 0);
+			if (options.racing) {
+				RaceOptions race = options.race;
+				race.minSurvivors = mu;
+				race.cache = nullptr;
+				race.evaluate = [&](size_t problem, const std::vector<size_t>& alive) {
+					return evaluator.evaluate(configs, alive, problem);
+				};
+				RaceResult raced = raceConfigs(training, configs, race);
+				std::vector<size_t> eliminated;
+				for (size_t k = 0; k < lambda; ++k) {
+					if (raced.eliminatedAfter[k] >= 0) eliminated.push_back(k);
+				}
+				std::stable_sort(eliminated.begin(), eliminated.end(), [&](size_t a, size_t b) {
+					if (raced.eliminatedAfter[a] != raced.eliminatedAfter[b]) return raced.eliminatedAfter[a] > raced.eliminatedAfter[b];
+					return raced.meanMakeSpan[a] < raced.meanMakeSpan[b];
+				});
+				order = raced.survivors;
+				order.insert(order.end(), eliminated.begin(), eliminated.end());
+				for (size_t k : raced.survivors) {
+					if (raced.meanMakeSpan[k] < result.meanMakeSpan) {
+						result.meanMakeSpan = raced.meanMakeSpan[k];
+						result.params = x[k];
+					}
+				}
+			}
+			else {
+				Matrix makeSpans = evaluator.evaluate(configs);
+				std::vector<double> fitness(lambda);
+				for (size_t k = 0; k < lambda; ++k) fitness[k] = ConstructionAlgorithm::mean(makeSpans[k]);
+				std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a] < fitness[b]; });
+				if (fitness[order[0]] < result.meanMakeSpan) {
+					result.meanMakeSpan = fitness[order[0]];
+					result.params = x[order[0]];
+				}
+			}
+
+			// mean, evolution paths
+			for (size_t i = 0; i < n; ++i) {
+				double newMean = 0;
+				for (size_t k = 0; k < mu; ++k) newMean += weights[k] * x[order[k]][i];
+				meanStep[i] = (newMean - mean[i]) / sigma;
+				mean[i] = newMean;
+			}
+			// C^-1/2 meanStep = B D^-1/2 B^T meanStep
+			for (size_t j = 0; j < n; ++j) {
+				z[j] = 0;
+				for (size_t i = 0; i < n; ++i) z[j] += B[i][j] * meanStep[i];
+				z[j] /= std::sqrt(D[j]);
+			}
+			double psNorm = 0;
+			for (size_t i = 0; i < n; ++i) {
+				whitened[i] = 0;
+				for (size_t j = 0; j < n; ++j) whitened[i] += B[i][j] * z[j];
+				ps[i] = (1 - cs) * ps[i] + std::sqrt(cs * (2 - cs) * muEff) * whitened[i];
+				psNorm += ps[i] * ps[i];
+			}
+			psNorm = std::sqrt(psNorm);
+			bool hsig = psNorm / std::sqrt(1 - std::pow(1 - cs, 2.0 * (generation + 1))) / chiN < 1.4 + 2.0 / (n + 1);
+			for (size_t i = 0; i < n; ++i) pc[i] = (1 - cc) * pc[i] + (hsig ? std::sqrt(cc * (2 - cc) * muEff) * meanStep[i] : 0.0);
+
+			// rank-one and rank-mu update
+			for (size_t i = 0; i < n; ++i) {
+				for (size_t j = 0; j <= i; ++j) {
+					double rankMu = 0;
+					for (size_t k = 0; k < mu; ++k) rankMu += weights[k] * y[order[k]][i] * y[order[k]][j];
+					double value = (1 - c1 - cmu) * C[i][j] + c1 * (pc[i] * pc[j] + (hsig ? 0.0 : cc * (2 - cc) * C[i][j])) + cmu * rankMu;
+					C[i][j] = C[j][i] = value;
+				}
+			}
+			sigma *= std::exp((cs / damps) * (psNorm / chiN - 1));
+
+			++result.generations;
+			if (options.onGeneration) options.onGeneration(target.name, generation, result.meanMakeSpan);
+		}
+
+		result.evaluations = evaluator.evaluations();
+		callerSettings.apply();
+		return result;
+	}
+
+	std::vector<TuneResult> tuneParams(const std::vector<JobContainer>& training, const std::vector<TuneTarget>& targets,
+		const TuneOptions& options)
+	{
+		std::vector<TuneResult> results;
+		for (const TuneTarget& target : targets) results.push_back(tuneParams(training, target, options));
+		return results;
+	}
+
+	void writeParamFiles(const std::string& directory, const std::string& family, const std::vector<TuneResult>& results)
+	{
+		for (const TuneResult& result : results) {
+			std::string path = directory + "/" + result.name + "_params.csv";
+			std::vector<std::string> lines;
+			{
+				std::ifstream in(path);
+				std::string line;
+				while (std::getline(in, line)) {
+					if (!line.empty() && line.back() == '\r') line.pop_back();
+					if (line.empty() || line.substr(0, line.find(',')) == family) continue;
+					lines.push_back(line);
+				}
+			}
+			// no trailing comma, readParamMap converts every field after the family name
+			std::ostringstream familyLine;
+			familyLine.precision(17);
+			familyLine << family;
+			for (double param : result.params) familyLine << "," << param;
+			lines.push_back(familyLine.str());
+
+			std::ofstream out(path, std::ios::trunc);
+			for (const std::string& line : lines) out << line << "\n";
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Racing.h"
+#include <functional>
+
+namespace ConstructionAlgorithm {
+	/* One planner whose params are tuned */
+	struct TuneTarget {
+		std::string name;				// algorithm name in the params files, e.g. "CP_HF_Planner"
+		ConstructionSolver::ConstrutionFunction planner;
+		std::vector<double> initial;	// start mean, its size is the dimension
+		double sigma = 0.5;				// start step size
+	};
+
+	/* HF2, CP_HF, TBOP_HF (3 params each) and EIT_OT (1), all starting from 0 (plain earliest end time) */
+	std::vector<TuneTarget> tuneTargets();
+
+	struct TuneOptions {
+		size_t populationSize = 0;		// lambda, 0 -> 4 + 3 ln(dimension)
+		size_t generations = 100;
+		double timeLimit = 0.0;			// seconds per target, 0 -> none
+		double tolerance = 1e-4;		// stop when sigma times the longest axis of C falls below
+		unsigned threadCount = 0;		// 0 -> hardware concurrency
+		bool racing = false;			// rank every generation with raceConfigs instead of full evaluation
+		RaceOptions race;				// minSurvivors and evaluate are set by the tuner, TuneOptions' threads and cache apply
+		ResultCache* cache = nullptr;	// runs found here are reused, new ones stored
+		uint64_t seed = 1;
+		std::function<void(const std::string& name, size_t generation, double bestMeanMakeSpan)> onGeneration;
+	};
+
+	struct TuneResult {
+		std::string name;
+		std::vector<double> params;		// best vector that ran every training problem
+		double meanMakeSpan = 0.0;		// of params over the training problems
+		double initialMeanMakeSpan = 0.0;
+		size_t generations = 0;
+		size_t evaluations = 0;			// planner runs, cache hits included
+	};
+
+	/* CMA-ES (Hansen's (mu/mu_w, lambda) with rank-one and rank-mu updates and cumulative step size
+	   adaptation) minimising the mean makespan over the training problems. A generation's lambda x
+	   problems runs go to a worker pool; every worker copies each problem once and restarts the copy for
+	   later runs, so the problems are parsed and copied once for the whole tune. With racing a generation
+	   is a race of its candidates on the same pool and copies. Survivors rank first by mean rank, and
+	   eliminated candidates fill the rest of the top mu by how long they lasted (then mean makespan over
+	   the problems they ran); only survivors can become the best. Sampling uses Xoshiro256::stream(seed, g)
+	   for generation g, so the result doesn't depend on the thread count. Planner settings of the calling
+	   thread (dispatch modes) are passed to the workers; its params are given back afterwards. */
+	TuneResult tuneParams(const std::vector<JobContainer>& training, const TuneTarget& target,
+		const TuneOptions& options = TuneOptions());
+
+	/* every target in turn */
+	std::vector<TuneResult> tuneParams(const std::vector<JobContainer>& training, const std::vector<TuneTarget>& targets,
+		const TuneOptions& options = TuneOptions());
+
+	/* Writes the results as readParamMap reads them: <directory>/<name>_params.csv per target with one
+	   "family,p0,p1,..." line per problem family. Lines of other families already in the file are kept,
+	   the family's own line is replaced. */
+	void writeParamFiles(const std::string& directory, const std::string& family, const std::vector<TuneResult>& results);
+}
@@ -1,7 +1,8 @@
 #include "Window.h"
+#include "Random.hpp"
 #include <iostream>
 
-Window::Window()
+Window::Window(uint64_t colorSeed)
 {
 	//m_window = sf::RenderWindow>(new sf::RenderWindow(sf::VideoMode(800, 600), "FJSS Visualization"));
 	m_window.create(sf::VideoMode(1600, 800), "FJSS Visualization");
@@ -12,12 +13,14 @@ Window::Window()
 	m_jobProgressWidget.setRect(sf::FloatRect(1120, 10, 600, 780));
 	m_jobProgressWidget.setBorderRect(sf::FloatRect(0, 0, 500, 3000));
 	m_constructionSolver = nullptr;
+	m_pendingSteps = 0;
 
 	updateResizeWidgets();
 
+	fjss::Xoshiro256 rng(colorSeed);
 	std::unordered_map<int, sf::Color> colorJobIdMap;
 	for (int i = 0; i < 30; ++i) {
-		colorJobIdMap[i] = sf::Color(rand() % 255, rand() % 255, rand() % 255);
+		colorJobIdMap[i] = sf::Color(rng.uniformInt(255), rng.uniformInt(255), rng.uniformInt(255));
 	}
 	m_scheduleWidget.setColorMap(colorJobIdMap);
 	m_jobProgressWidget.setColorMap(colorJobIdMap);
@@ -53,20 +56,22 @@ void Window::start()
 				if (event.key.code == sf::Keyboard::Num1) {
 					if (m_constructionSolver == nullptr) continue;
 					if (m_constructionSolver->isDone()) continue;
-					m_constructionSolver->scheduleStep();
+					m_pendingSteps += 1;
 				}
 				if (event.key.code == sf::Keyboard::Num2) {
 					if (m_constructionSolver == nullptr) continue;
 					if (m_constructionSolver->isDone()) continue;
-					m_constructionSolver->scheduleStep(10);
+					m_pendingSteps += 10;
 				}
 				if (event.key.code == sf::Keyboard::Num3) {
 					if (m_constructionSolver == nullptr) continue;
+					m_pendingSteps = 0;
 					m_constructionSolver->getSchedule().clear();
 					m_constructionSolver->getJobContainer().restartContainer();
 				}
 			}
 		}
+		pullPendingSteps();
 
 		m_window.clear(sf::Color(200,200,200));
 		m_scheduleWidget.draw(m_window);
@@ -84,6 +89,17 @@ void Window::setConstructionSolver(ConstructionAlgorithm::ConstructionSolver* co
 	m_jobProgressWidget.setJobContainer(&m_constructionSolver->getJobContainer());
 }
 
+void Window::pullPendingSteps()
+{
+	// steps are pulled a few per frame so long requests don't block the event loop
+	if (m_constructionSolver == nullptr || m_pendingSteps == 0) return;
+	int steps = std::min(m_pendingSteps, WindowUi::stepsPerFrame);
+	m_pendingSteps -= steps;
+	if (!m_constructionSolver->resume(steps)) {
+		m_pendingSteps = 0;
+	}
+}
+
 void Window::updateResizeWidgets()
 {
 	sf::Vector2f windowSize = (sf::Vector2f)m_window.getView().getSize();
@@ -8,7 +8,7 @@
 class Window
 {
 public:
-	Window();
+	Window(uint64_t colorSeed = 1);
 	void start();
 	ScheduleWidget m_scheduleWidget;
 	JobProgressWidget m_jobProgressWidget;
@@ -17,6 +17,12 @@ public:
 
 private:
 	void updateResizeWidgets();
+	void pullPendingSteps();
 	sf::RenderWindow m_window;
+	int m_pendingSteps;	// requested steps not pulled from the solver yet
 };
 
+namespace WindowUi {
+	const int stepsPerFrame = 5;
+}
+
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FJSS.hpp"
+#include "Random.hpp"
 #include "json.hpp"
 #include <fstream>
 
@@ -82,8 +83,9 @@ fjss::JobContainer parseBrandiMarteProblem(std::ifstream& fileStream) {
 
 
 
-// Brandimarte generator
-void generateBrandimarteProblemSet(std::vector<fjss::JobContainer>& problemSet, const std::string& sourceTypeFileName, int setSize) {
+// Brandimarte generator, same seed gives the same problem set
+void generateBrandimarteProblemSet(std::vector<fjss::JobContainer>& problemSet, const std::string& sourceTypeFileName, int setSize, uint64_t seed) {
+	fjss::Xoshiro256 rng(seed);
 	std::ifstream sourceFile(sourceTypeFileName);
 	fjss::JobContainer jobContainer = parseBrandiMarteProblem(sourceFile);
 	int n_org = jobContainer.getJobs().size();
@@ -92,11 +94,11 @@ void generateBrandimarteProblemSet(std::vector<fjss::JobContainer>& problemSet,
 
 	for (int i = 0; i < setSize; ++i) {
 		fjss::JobContainer problemInstance;
-		int jobCount = l_bound + (rand() % (u_bound - l_bound + 1));
+		int jobCount = l_bound + rng.uniformInt(u_bound - l_bound + 1);
 		problemInstance.setStationCount(jobContainer.stationCount());
 		
 		for (fjss::JobID j = 0; j < jobCount; ++j) {
-			int jobType = rand() % n_org;
+			int jobType = rng.uniformInt(n_org);
 			fjss::Job job = jobContainer.getJob(jobType);
 			job.jobID = j;
 			problemInstance.addJob(job);
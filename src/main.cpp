@@ -5,6 +5,11 @@
 #include "GPUfjss.h"
 #include "Window.h"
 #include "ConstructionAlgorithms.h"
+#include "Portfolio.h"
+#include "Racing.h"
+#include "Selector.h"
+#include "FeatureExtractor.h"
+#include "ResultCache.h"
 #include <filesystem>
 //#include <Windows.h>
 #include <string>
@@ -21,11 +26,143 @@ using namespace fjss;
 
 std::map<std::string, std::map<std::string, std::vector<double>>> readParamMap();
 
+// problems used from every data file by the race, selector training and selected runs
+const size_t problemsPerFile = 100;
+
 
 std::vector<std::string> getFilesInDirectory(const std::string& directory) {
 	std::vector<std::string> files;
     for (const auto & entry : std::filesystem::directory_iterator(directory))
 		files.push_back(entry.path());
+	return files;
+}
+
+// Racing evaluation: per file, configs significantly worse than the best are dropped early.
+// Score row marks the surviving (winning) configs, makespan row holds means over the problems each config ran.
+void raceDataFiles(const std::string& path, const std::vector<ConstructionAlgorithm::PlannerConfig>& configs,
+	std::ofstream& out_file, std::ofstream& out_file_makeSpans, ConstructionAlgorithm::ResultCache& cache) {
+	std::vector<std::string> files = getFilesInDirectory(path);
+	int filec = 0;
+	ConstructionAlgorithm::RaceOptions options;
+	options.cache = &cache;
+	for (const auto& file : files) {
+		std::ifstream ifs(file);
+		nlohmann::json j = nlohmann::json::parse(ifs);
+		std::vector<JobContainer> problems;
+		for (const auto& problemJSON : j) {
+			problems.push_back(parseProblem(problemJSON));
+			if (problems.size() >= problemsPerFile) break;
+		}
+
+		std::string proxy_file = file;
+		proxy_file.erase(0, path.length() + 1);
+		std::cout << proxy_file << " " << ++filec << "/" << files.size() << "\n";
+		ConstructionAlgorithm::RaceResult race = ConstructionAlgorithm::raceConfigs(problems, configs, options);
+		std::cout << "evaluations: " << race.evaluations << "/" << problems.size() * configs.size() << "\n";
+
+		out_file << proxy_file << ",";
+		out_file_makeSpans << proxy_file << ",";
+		for (size_t i = 0; i < configs.size(); ++i) {
+			out_file << (race.eliminatedAfter[i] == -1 ? 1 : 0) << ",";
+			out_file_makeSpans << race.meanMakeSpan[i] << ",";
+		}
+		out_file << "null\n";
+		out_file_makeSpans << "null\n";
+	}
+}
+
+// Selector training: one sample per problem, labelled with that problem's own makespans of every config.
+// Runs of earlier batches come from the cache, so only configs it hasn't seen on a problem are run.
+void trainSelector(const std::string& path, const std::vector<ConstructionAlgorithm::PlannerConfig>& configs,
+	ConstructionAlgorithm::ResultCache& cache, const std::string& modelPath) {
+	std::vector<std::string> files = getFilesInDirectory(path);
+	std::vector<std::vector<double>> samples, makeSpans;
+	int filec = 0;
+	for (const auto& file : files) {
+		std::ifstream ifs(file);
+		nlohmann::json j = nlohmann::json::parse(ifs);
+
+		std::string proxy_file = file;
+		proxy_file.erase(0, path.length() + 1);
+		std::cout << proxy_file << " " << ++filec << "/" << files.size() << "\n";
+		size_t pc = 0;
+		for (const auto& problemJSON : j) {
+			JobContainer problem = parseProblem(problemJSON);
+			ConstructionAlgorithm::PortfolioResult portfolio = ConstructionAlgorithm::runPortfolioCached(problem, configs, cache);
+			samples.push_back(ConstructionAlgorithm::instanceFeatures(problem));
+			makeSpans.emplace_back(portfolio.makeSpans.begin(), portfolio.makeSpans.end());
+			if (++pc >= problemsPerFile) break;
+		}
+	}
+	std::cout << "selector trained on " << samples.size() << " problems from " << files.size() << " files\n";
+	std::vector<std::string> plannerNames;
+	for (const auto& config : configs) plannerNames.push_back(config.name);
+	ConstructionAlgorithm::PlannerSelector selector;
+	selector.train(plannerNames, samples, makeSpans);
+	selector.save(modelPath);
+}
+
+// Feature table: one row per problem, read straight from the files without parsing them into objects.
+void featureDataFiles(const std::string& path, std::ofstream& out_file) {
+	out_file << "file,problem,";
+	for (const std::string& name : ConstructionAlgorithm::InstanceFeatures::names()) out_file << name << ",";
+	out_file << "null\n";
+	std::vector<std::string> files = getFilesInDirectory(path);
+	int filec = 0;
+	for (const auto& file : files) {
+		std::ifstream ifs(file);
+		std::string proxy_file = file;
+		proxy_file.erase(0, path.length() + 1);
+		size_t problems = ConstructionAlgorithm::streamFeatures(ifs, [&](const std::string& name, const ConstructionAlgorithm::InstanceFeatures& features) {
+			out_file << proxy_file << "," << name << ",";
+			for (double value : features.values) out_file << value << ",";
+			out_file << "null\n";
+			return true;
+		});
+		std::cout << proxy_file << " " << ++filec << "/" << files.size() << " problems: " << problems << "\n";
+	}
+}
+
+// Selected evaluation: per problem only the k configs the model ranks best run.
+// Score row counts wins among the configs that ran, makespan row holds means over the problems each config ran.
+void selectDataFiles(const std::string& path, const std::vector<ConstructionAlgorithm::PlannerConfig>& configs,
+	const ConstructionAlgorithm::PlannerSelector& selector, size_t k, std::ofstream& out_file, std::ofstream& out_file_makeSpans,
+	ConstructionAlgorithm::ResultCache& cache) {
+	std::vector<std::string> files = getFilesInDirectory(path);
+	int filec = 0;
+	for (const auto& file : files) {
+		std::ifstream ifs(file);
+		nlohmann::json j = nlohmann::json::parse(ifs);
+
+		std::string proxy_file = file;
+		proxy_file.erase(0, path.length() + 1);
+		std::cout << proxy_file << " " << ++filec << "/" << files.size() << "\n";
+		std::vector<int> score(configs.size(), 0), runs(configs.size(), 0);
+		std::vector<double> makeSpanSum(configs.size(), 0.0);
+		size_t pc = 0;
+		for (const auto& problemJSON : j) {
+			JobContainer problem = parseProblem(problemJSON);
+			std::vector<ConstructionAlgorithm::PlannerConfig> selected = selector.select(problem, configs, k);
+			ConstructionAlgorithm::PortfolioResult portfolio = ConstructionAlgorithm::runPortfolioCached(problem, selected, cache);
+			for (size_t s = 0; s < selected.size(); ++s) {
+				size_t i = 0;
+				while (configs[i].name != selected[s].name) ++i;
+				score[i] += portfolio.makeSpans[s] == portfolio.bestMakeSpan;
+				makeSpanSum[i] += portfolio.makeSpans[s];
+				++runs[i];
+			}
+			if (++pc >= problemsPerFile) break;
+		}
+
+		out_file << proxy_file << ",";
+		out_file_makeSpans << proxy_file << ",";
+		for (size_t i = 0; i < configs.size(); ++i) {
+			out_file << score[i] << ",";
+			out_file_makeSpans << (runs[i] > 0 ? makeSpanSum[i] / runs[i] : 0.0) << ",";
+		}
+		out_file << "null\n";
+		out_file_makeSpans << "null\n";
+	}
 }
 
 
@@ -34,7 +171,6 @@ int main() {
 #define VIS
 #ifdef VIS
 	// VISUALIZATION
-	srand(time(NULL));
 	Window w;
 	//std::ifstream ifss("C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD"
 	//	"\\test_data_3\\rnd_JT(5)_J(15)_M(5)_JO(5-10)_O(20)_OM(1-3)_test.json");
@@ -54,7 +190,6 @@ int main() {
 
 	return 1;
 #endif
-	srand(time(NULL));
 
 	std::ofstream out_file, out_file_makeSpans;
 	out_file.open("C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD\\output.csv");
@@ -66,21 +201,49 @@ int main() {
 	int dispatch_operation_count = 3;// 10;	// current num of operation dispatching rules
 	int dispatch_station_count = 2;// 3;		// current num of station dispatching rules
 
-	std::vector<std::pair<int, int>> plannerProgram; // op/station
-	for (int station = 0; station < dispatch_station_count; ++station) {
-		for (int operation = 0; operation < dispatch_operation_count; ++operation) {
-			plannerProgram.push_back({ operation, station });
-		}
-	}
+	std::vector<PlannerConfig> plannerProgram = dispatchConfigs(dispatch_operation_count, dispatch_station_count); // op/station
 	for (auto& it : plannerProgram) {
-		out_file << "OP" << it.first << " - ST" << it.second << ",";
-		out_file_makeSpans << "OP" << it.first << " - ST" << it.second << ",";
+		out_file << it.name << ",";
+		out_file_makeSpans << it.name << ",";
 	}
 	out_file << "null\n";
 	out_file_makeSpans << "null\n";
 	int filec = 0;
 
 	std::string path = "C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD\\test_data_3";
+	// runs of earlier experiments are looked up instead of recomputed, delete the file after changing a planner
+	ResultCache cache("C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD\\results_cache.txt");
+//#define RACE
+#ifdef RACE
+	raceDataFiles(path, plannerProgram, out_file, out_file_makeSpans, cache);
+	out_file.close();
+	return 0;
+#endif
+	// SELECT_TRAIN fits the selector on every config's makespans per problem (mostly from the cache),
+	// SELECT runs only its top 3 configs per problem
+	std::string selectorPath = "C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD\\selector.txt";
+//#define FEATURES
+#ifdef FEATURES
+	std::ofstream features_file("C:\\Users\\chedo\\OneDrive\\Pulpit\\POLITECHNIKA WARSZAWSKA\\PBAD\\features.csv");
+	featureDataFiles(path, features_file);
+	return 0;
+#endif
+//#define SELECT_TRAIN
+#ifdef SELECT_TRAIN
+	trainSelector(path, plannerProgram, cache, selectorPath);
+	return 0;
+#endif
+//#define SELECT
+#ifdef SELECT
+	PlannerSelector selector;
+	if (!selector.load(selectorPath)) {
+		std::cout << "no selector model at " << selectorPath << ", run SELECT_TRAIN first\n";
+		return 1;
+	}
+	selectDataFiles(path, plannerProgram, selector, 3, out_file, out_file_makeSpans, cache);
+	out_file.close();
+	return 0;
+#endif
 	std::vector<std::string> files = getFilesInDirectory(path);
 
 	for (const auto& file : files) {
@@ -97,31 +260,15 @@ int main() {
 		std::vector<int> avgMakespan(plannerProgram.size(), 0);
 
 		for (const auto& problemJSON : j) {
-			float bestMakeSpan = std::numeric_limits<float>::max();
-			std::vector<int> bestPlanners;
+			// parsed once, all planner combinations run in parallel on the same instance
+			JobContainer problem = parseProblem(problemJSON);
+			PortfolioResult portfolio = runPortfolioCached(problem, plannerProgram, cache);
 
 			for (int i = 0; i < plannerProgram.size(); ++i) {
-				JobContainer jc = parseProblem(problemJSON);
-				jc.restartContainer();
-				Schedule sch(jc.stationCount());
-				dispatch_operation_mode = plannerProgram[i].first;
-				dispatch_station_mode = plannerProgram[i].second;
-				ConstructionAlgorithm::ConstructionSolver solver(jc, sch, Dispatch_Planner);
-				solver.scheduleAll();
-				float makeSpan = sch.makeSpan();
-				if (makeSpan < bestMakeSpan) {
-					bestMakeSpan = makeSpan;
-					bestPlanners.clear();
-					bestPlanners.push_back(i);
+				if (portfolio.makeSpans[i] == portfolio.bestMakeSpan) {
+					score[i] += 1;
 				}
-				else if (makeSpan == bestMakeSpan) {
-					bestPlanners.push_back(i);
-				}
-				avgMakespan[i] += makeSpan;
-			}
-
-			for (auto& v : bestPlanners) {
-				score[v] += 1;
+				avgMakespan[i] += portfolio.makeSpans[i];
 			}
 
 			if (++pc > 100) break;